@@ -38,6 +38,7 @@
               wayland
               wayland-protocols
               yaml-cpp
+              liburing
             ];
 
             qtWrapperArgs = [
@@ -89,6 +90,7 @@
               wayland
               wayland-protocols
               yaml-cpp
+              liburing
             ];
 
             shellHook = ''
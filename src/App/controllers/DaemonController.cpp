@@ -112,30 +112,28 @@ void DaemonController::processMessage(QLocalSocket *socket, const QJsonObject &m
     } else if (action == "reload") {
         // Implementation for reload needed: just re-exec with same settings?
         // For now, just reload the set.
+        m_launcher->invalidateItems();
         m_launcher->loadSet(""); // default
         sendResponse(socket, "ok", "Reloading...");
     } else if (action == "query") {
         QString text = payload.value("text").toString();
         int limit = payload.value("limit").toInt(10);
         
-        m_launcher->filter(text);
-        
         QJsonObject data;
         QJsonArray items;
         
         auto model = m_launcher->model();
         if (model) {
-            auto displayed = model->getDisplayedItems();
-            int count = 0;
-            for (const auto& item : displayed) {
-                if (count >= limit) break;
+            // The reply needs the results now, so filter synchronously
+            model->filter(text);
+            const int count = model->loadRows(limit);
+            for (int row = 0; row < count; ++row) {
                 QJsonObject jItem;
-                jItem["id"] = item.id;
-                jItem["primary"] = item.primary;
-                jItem["secondary"] = item.secondary;
-                jItem["exec"] = item.exec;
+                jItem["id"] = model->rowText(row, ItemStore::Id).toString();
+                jItem["primary"] = model->rowText(row, ItemStore::Primary).toString();
+                jItem["secondary"] = model->rowText(row, ItemStore::Secondary).toString();
+                jItem["exec"] = model->rowText(row, ItemStore::Exec).toString();
                 items.append(jItem);
-                count++;
             }
         }
         
@@ -1,8 +1,12 @@
 #include "LauncherController.h"
 #include "../models/LauncherModel.h"
+#include "../providers/DesktopIndex.h"
 #include "../providers/DesktopProvider.h"
+#include "../providers/PathIndex.h"
+#include "../providers/ProcessMonitor.h"
 #include "../providers/PathProvider.h"
 #include "../providers/ProcessProvider.h"
+#include "../providers/ProcessTable.h"
 #include "../providers/SSHProvider.h"
 #include "../providers/StdinProvider.h"
 #include "../providers/WindowProvider.h"
@@ -13,9 +17,110 @@
 #include "../utils/TerminalUtils.h"
 #include <QDir>
 #include <QFile>
+#include <QThreadPool>
+#include <QTimer>
+#include <algorithm>
+#include <iterator>
+#include <utility>
 #include <signal.h>
 
-LauncherController::LauncherController(QObject *parent) : QObject(parent) {}
+namespace {
+
+/** @brief One ProcessProvider::scan() of a top/kill provider. */
+struct ProcessScan {
+  bool topMode = false;
+  int limit = -1;
+  ProcessProvider::SortMode sort = ProcessProvider::MEMORY;
+  bool showSystem = false;
+  bool listed = false;   // Read only pids, from a ProcessTable
+  std::vector<int> pids;
+};
+
+// Takes the current process list from @p table, if it is live
+void listProcesses(ProcessScan &scan, const ProcessTable *table) {
+  scan.listed = table && table->isActive();
+  scan.pids = scan.listed ? table->pids(scan.showSystem) : std::vector<int>();
+}
+
+// Reads the config on the GUI thread; the scan itself may run anywhere
+ProcessScan processScan(const QString &provider) {
+  ProcessScan scan;
+  if (provider == Constants::ProviderTop) {
+    scan.topMode = true;
+    scan.limit = Config::instance().getInt("top.limit", 10);
+    QString sortStr = Config::instance().getString("top.sort", "cpu");
+    scan.sort = (sortStr == "memory") ? ProcessProvider::MEMORY
+                                      : ProcessProvider::CPU;
+  } else {
+    scan.showSystem =
+        Config::instance().getString("kill.show_system", "false") == "true";
+  }
+  return scan;
+}
+
+std::vector<LauncherItem>
+runScan(const ProcessScan &scan, const ProcessProvider::CpuSnapshot *baseline,
+        ProcessProvider::CpuSnapshot *sample) {
+  return ProcessProvider::scan(scan.topMode, scan.limit, scan.sort,
+                               scan.showSystem, baseline, sample,
+                               scan.listed ? &scan.pids : nullptr);
+}
+
+void applySetFilter(std::vector<LauncherItem> &items,
+                    const Config::FilterRule &rule) {
+  if (rule.include.isEmpty() && rule.exclude.isEmpty())
+    return;
+
+  std::vector<LauncherItem> filtered;
+  for (const auto &item : items) {
+    bool keep = true;
+    if (!rule.exclude.isEmpty()) {
+      if (FilterUtils::matches(item.primary, rule.exclude) ||
+          FilterUtils::matches(item.id, rule.exclude))
+        keep = false;
+    }
+    if (keep && !rule.include.isEmpty()) {
+      bool included = false;
+      if (FilterUtils::matches(item.primary, rule.include) ||
+          FilterUtils::matches(item.id, rule.include))
+        included = true;
+      if (!included)
+        keep = false;
+    }
+    if (keep)
+      filtered.push_back(item);
+  }
+  items = std::move(filtered);
+}
+
+} // namespace
+
+struct LauncherController::LiveRefresh {
+  /** @brief A provider of the set: rescanned, or its items kept as loaded. */
+  struct Part {
+    bool process = false;
+    ProcessScan scan;
+    std::vector<LauncherItem> items;
+  };
+  std::vector<Part> parts;
+  Config::FilterRule filter;
+  ProcessProvider::CpuSnapshot baseline; // What the shown rows were read at
+};
+
+LauncherController::LauncherController(QObject *parent)
+    : QObject(parent), m_refreshTimer(new QTimer(this)),
+      m_refreshPool(new QThreadPool(this)) {
+  // One scan at a time; a request that finds one running follows it
+  m_refreshPool->setMaxThreadCount(1);
+  connect(m_refreshTimer, &QTimer::timeout, this,
+          &LauncherController::refreshProcesses);
+}
+
+LauncherController::~LauncherController() {
+  // A running refresh posts its result back to this object
+  m_refreshPool->clear();
+  m_refreshPool->waitForDone();
+}
 
 #include <QCoreApplication>
 #include <QProcess>
@@ -45,7 +150,8 @@ void LauncherController::setDaemonMode(bool enabled) { m_daemonMode = enabled; }
 
 void LauncherController::filter(const QString &text) {
   if (m_model) {
-    m_model->filter(text);
+    // Large sets are scored off the GUI thread so typing never stalls
+    m_model->requestFilter(text);
   }
 }
 
@@ -239,6 +345,7 @@ void LauncherController::beginMoveToMonitor(int index) {
 
   m_pendingHandle = itemId;
   m_selectionMode = MonitorSelect;
+  m_loadedKey.clear(); // The model is about to hold monitors instead
   m_promptOverride = "Move to Monitor...";
   emit selectionModeChanged();
   emit promptOverrideChanged();
@@ -255,7 +362,7 @@ void LauncherController::beginMoveToMonitor(int index) {
     item.iconKey = "video-display";
     monitorItems.push_back(item);
   }
-  m_model->setItems(monitorItems);
+  m_model->setItems(std::move(monitorItems));
 }
 
 void LauncherController::setVisible(bool visible) {
@@ -273,6 +380,7 @@ void LauncherController::setVisible(bool visible) {
 
   // Clear search when hiding
   if (!visible) {
+    stopRefresh();
     emit clearSearch();
   }
 }
@@ -289,12 +397,81 @@ void LauncherController::toggle() { setVisible(!m_visible); }
 
 void LauncherController::quit() { QCoreApplication::quit(); }
 
+bool LauncherController::isIndexed(const QString &provider) const {
+  return (provider == Constants::ProviderDrun && m_desktopIndex) ||
+         (provider == Constants::ProviderRun && m_pathIndex);
+}
+
+quint64 LauncherController::indexVersion() const {
+  // Versions only grow, so the sum changes whenever either index does
+  return (m_desktopIndex ? m_desktopIndex->version() : 0) +
+         (m_pathIndex ? m_pathIndex->version() : 0);
+}
+
+void LauncherController::stopRefresh() {
+  m_refreshTimer->stop();
+  m_liveRefresh.reset();
+  ++m_refreshGeneration;
+}
+
+void LauncherController::refreshProcesses() {
+  if (!m_liveRefresh || !m_model || !m_visible)
+    return;
+  if (m_refreshRunning) {
+    // It may be of the previous set, whose CPU sample must not be lost
+    m_refreshQueued = true;
+    return;
+  }
+  m_refreshRunning = true;
+
+  // Scanning, indexing and boosts happen on the pool; the GUI thread only
+  // rescores the query and diffs the visible rows
+  LiveRefresh refresh = *m_liveRefresh;
+  for (auto &part : refresh.parts) {
+    if (part.process)
+      listProcesses(part.scan, m_processTable);
+  }
+  const quint64 generation = m_refreshGeneration;
+  const auto ranking = m_model->rankingContext();
+  m_refreshPool->start([this, refresh, ranking, generation]() {
+    ProcessProvider::CpuSnapshot sample;
+    std::vector<LauncherItem> items;
+    for (const auto &part : refresh.parts) {
+      if (!part.process) {
+        items.insert(items.end(), part.items.begin(), part.items.end());
+        continue;
+      }
+      auto scanned = runScan(part.scan, &refresh.baseline, &sample);
+      items.insert(items.end(), std::make_move_iterator(scanned.begin()),
+                   std::make_move_iterator(scanned.end()));
+    }
+    applySetFilter(items, refresh.filter);
+    const auto prepared =
+        LauncherModel::prepareItems(std::move(items), ranking);
+
+    QMetaObject::invokeMethod(
+        this,
+        [this, prepared, sample, generation]() {
+          m_refreshRunning = false;
+          // The set was switched or hidden while we scanned
+          if (generation == m_refreshGeneration && m_liveRefresh) {
+            m_liveRefresh->baseline = sample;
+            m_model->replaceItems(prepared);
+          }
+          if (std::exchange(m_refreshQueued, false))
+            refreshProcesses();
+        },
+        Qt::QueuedConnection);
+  });
+}
+
 void LauncherController::loadSet(const QString &setName,
                                  const QString &modeOverride) {
   if (!m_model)
     return;
 
   m_currentSetName = setName;
+  stopRefresh();
 
   Config::ProviderSet activeSet;
   bool usingSet = false;
@@ -331,9 +508,9 @@ void LauncherController::loadSet(const QString &setName,
   }
   emit modeChanged();
 
-  // Notify model of active set (for Pins/Aliases)
+  // Resolve pins, aliases and scoring once per set instead of per keystroke
   if (m_model) {
-    m_model->setSetName(activeSet.name);
+    m_model->setRankingContext(RankingContext::forSet(activeSet.name));
   }
 
   // Update prompt/icon
@@ -361,29 +538,73 @@ void LauncherController::loadSet(const QString &setName,
     Config::instance().setOverrides(setOverrides);
   }
 
+  // Sets of indexed apps only change with the index, so showing one again
+  // keeps the model's items instead of aggregating them anew
+  const bool indexedOnly =
+      !activeSet.providers.isEmpty() &&
+      std::all_of(activeSet.providers.begin(), activeSet.providers.end(),
+                  [this](const QString &provider) {
+                    return isIndexed(provider);
+                  });
+  const QString loadedKey = setName + '\n' + m_mode;
+  if (indexedOnly && loadedKey == m_loadedKey &&
+      indexVersion() == m_loadedVersion) {
+    return;
+  }
+  m_loadedKey = indexedOnly ? loadedKey : QString();
+  m_loadedVersion = indexVersion();
+
   // Aggregation
   std::vector<LauncherItem> aggregatedItems;
+  auto liveRefresh = std::make_unique<LiveRefresh>();
+  int refreshMs = 0;
+  bool sampleCpu = false; // Top was listed without a CPU baseline
+  std::vector<std::pair<size_t, size_t>> spans; // Items of each provider
   for (const QString &providerName : activeSet.providers) {
+    const size_t spanBegin = aggregatedItems.size();
+    LiveRefresh::Part &part = liveRefresh->parts.emplace_back();
     if (providerName == Constants::ProviderRun) {
-      auto items = PathProvider::scan();
-      aggregatedItems.insert(aggregatedItems.end(), items.begin(), items.end());
+      if (m_pathIndex) {
+        const auto &items = m_pathIndex->items();
+        aggregatedItems.insert(aggregatedItems.end(), items.begin(),
+                               items.end());
+      } else {
+        auto items = PathProvider::scan();
+        aggregatedItems.insert(aggregatedItems.end(), items.begin(),
+                               items.end());
+      }
     } else if (providerName == Constants::ProviderDrun) {
-      auto items = DesktopProvider::scan();
-      aggregatedItems.insert(aggregatedItems.end(), items.begin(), items.end());
-    } else if (providerName == Constants::ProviderTop) {
-      int limit = Config::instance().getInt("top.limit", 10);
-      QString sortStr = Config::instance().getString("top.sort", "cpu");
-      ProcessProvider::SortMode sort = (sortStr == "memory")
-                                           ? ProcessProvider::MEMORY
-                                           : ProcessProvider::CPU;
-      auto items = ProcessProvider::scan(true, limit, sort, false);
-      aggregatedItems.insert(aggregatedItems.end(), items.begin(), items.end());
-    } else if (providerName == Constants::ProviderKill) {
-      bool showSystem =
-          Config::instance().getString("kill.show_system", "false") == "true";
-      auto items =
-          ProcessProvider::scan(false, -1, ProcessProvider::MEMORY, showSystem);
+      if (m_desktopIndex) {
+        const auto &items = m_desktopIndex->items();
+        aggregatedItems.insert(aggregatedItems.end(), items.begin(),
+                               items.end());
+      } else {
+        auto items = DesktopProvider::scan();
+        aggregatedItems.insert(aggregatedItems.end(), items.begin(),
+                               items.end());
+      }
+    } else if (providerName == Constants::ProviderTop ||
+               providerName == Constants::ProviderKill) {
+      ProcessScan scan = processScan(providerName);
+      listProcesses(scan, m_processTable);
+      // Without a monitor baseline (standalone, or before its first
+      // sample) top is listed by lifetime CPU time right away, and a second
+      // scan shortly after fills in CPU%. The first refresh of kill
+      // measures from this scan on.
+      const bool top = providerName == Constants::ProviderTop;
+      const ProcessProvider::CpuSnapshot *baseline =
+          top && m_processMonitor ? m_processMonitor->baseline() : nullptr;
+      if (top && scan.sort == ProcessProvider::CPU && !baseline)
+        sampleCpu = true;
+      auto items = runScan(scan, baseline, &liveRefresh->baseline);
       aggregatedItems.insert(aggregatedItems.end(), items.begin(), items.end());
+      part.process = true;
+      part.scan = scan;
+
+      const int interval = Config::instance().getInt(
+          providerName + ".refresh_ms", DefaultRefreshMs);
+      if (interval > 0 && (refreshMs == 0 || interval < refreshMs))
+        refreshMs = interval;
     } else if (providerName == Constants::ProviderSSH) {
       QString termCmd = Config::instance().getString("ssh.terminal", "");
       bool parseKnown = Config::instance().getString("ssh.parse_known_hosts",
@@ -398,34 +619,45 @@ void LauncherController::loadSet(const QString &setName,
                                wItems.end());
       }
     }
+    spans.emplace_back(spanBegin, aggregatedItems.size());
   }
 
-  // Filtering
-  if (!activeSet.filter.include.isEmpty() ||
-      !activeSet.filter.exclude.isEmpty()) {
-    std::vector<LauncherItem> filtered;
-    for (const auto &item : aggregatedItems) {
-      bool keep = true;
-      if (!activeSet.filter.exclude.isEmpty()) {
-        if (FilterUtils::matches(item.primary, activeSet.filter.exclude) ||
-            FilterUtils::matches(item.id, activeSet.filter.exclude))
-          keep = false;
-      }
-      if (keep && !activeSet.filter.include.isEmpty()) {
-        bool included = false;
-        if (FilterUtils::matches(item.primary, activeSet.filter.include) ||
-            FilterUtils::matches(item.id, activeSet.filter.include))
-          included = true;
-        if (!included)
-          keep = false;
-      }
-      if (keep)
-        filtered.push_back(item);
+  // Process lists go stale while open. Other providers' items go stale
+  // too, so only pure top/kill sets refresh periodically; the one CPU
+  // sample keeps those items as they are.
+  const bool periodic =
+      refreshMs > 0 &&
+      std::all_of(liveRefresh->parts.begin(), liveRefresh->parts.end(),
+                  [](const LiveRefresh::Part &part) { return part.process; });
+  if (sampleCpu) {
+    for (size_t i = 0; i < spans.size(); ++i) {
+      if (!liveRefresh->parts[i].process)
+        liveRefresh->parts[i].items.assign(
+            aggregatedItems.begin() + spans[i].first,
+            aggregatedItems.begin() + spans[i].second);
     }
-    aggregatedItems = filtered;
   }
 
-  m_model->setItems(aggregatedItems);
+  // Filtering
+  applySetFilter(aggregatedItems, activeSet.filter);
+
+  m_model->setItems(std::move(aggregatedItems));
+
+  if (periodic || sampleCpu) {
+    liveRefresh->filter = activeSet.filter;
+    m_liveRefresh = std::move(liveRefresh);
+  }
+  if (periodic)
+    m_refreshTimer->start(refreshMs);
+  if (sampleCpu) {
+    // Goes through the same path as a refresh tick, off the GUI thread
+    const quint64 generation = m_refreshGeneration;
+    QTimer::singleShot(ProcessProvider::FirstSampleMs, this,
+                       [this, generation]() {
+                         if (generation == m_refreshGeneration)
+                           refreshProcesses();
+                       });
+  }
 }
 
 #include <QWindow>
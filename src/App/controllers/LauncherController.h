@@ -2,6 +2,7 @@
 
 #include <QObject>
 #include <functional>
+#include <memory>
 
 /**
  * @class LauncherController
@@ -39,6 +40,7 @@ public:
     Q_PROPERTY(bool explicitScreen READ explicitScreen WRITE setExplicitScreen NOTIFY explicitScreenChanged)
 
     explicit LauncherController(QObject *parent = nullptr);
+    ~LauncherController() override;
 
     enum ActionFlag {
         None = 0,
@@ -87,6 +89,19 @@ public:
 
     void setDmenuMode(bool enabled);
     void setDaemonMode(bool enabled);
+    /** @brief Serves drun from a resident, live-updated index (daemon mode). */
+    void setDesktopIndex(class DesktopIndex* index) { m_desktopIndex = index; }
+    /** @brief Serves run from a resident, live-updated index (daemon mode). */
+    void setPathIndex(class PathIndex* index) { m_pathIndex = index; }
+    /** @brief Measures top's CPU% against a background sampler (daemon mode). */
+    void setProcessMonitor(class ProcessMonitor* monitor) { m_processMonitor = monitor; }
+    /** @brief Lists processes from an event-driven table instead of /proc (daemon mode). */
+    void setProcessTable(class ProcessTable* table) { m_processTable = table; }
+    /** @brief Makes the next loadSet() rebuild its items even if nothing changed. */
+    void invalidateItems() { m_loadedKey.clear(); }
+
+    /** @brief Default of top.refresh_ms / kill.refresh_ms; 0 disables. */
+    static constexpr int DefaultRefreshMs = 2000;
 
     SelectionMode selectionMode() const { return m_selectionMode; }
     QString promptOverride() const { return m_promptOverride; }
@@ -122,8 +137,29 @@ signals:
     void clearSearch();
 
 private:
+   /** @brief Set shown with live-refreshing rows, and its next CPU baseline. */
+   struct LiveRefresh;
+
+   bool isIndexed(const QString &provider) const;
+   quint64 indexVersion() const;
+   /** @brief Rescans a top/kill set off the GUI thread and swaps the rows in. */
+   void refreshProcesses();
+   void stopRefresh();
+
    class LauncherModel* m_model = nullptr;
    class WindowProvider* m_windowProvider = nullptr;
+   class DesktopIndex* m_desktopIndex = nullptr;
+   class PathIndex* m_pathIndex = nullptr;
+   class ProcessMonitor* m_processMonitor = nullptr;
+   class ProcessTable* m_processTable = nullptr;
+   QString m_loadedKey = "";   // Set and mode whose items the model holds, if reusable
+   quint64 m_loadedVersion = 0;
+   std::unique_ptr<LiveRefresh> m_liveRefresh; // Null: the set is not refreshed
+   class QTimer* m_refreshTimer = nullptr;
+   class QThreadPool* m_refreshPool = nullptr;
+   quint64 m_refreshGeneration = 0;  // Results of older generations are dropped
+   bool m_refreshRunning = false;
+   bool m_refreshQueued = false;    // Requested while running: runs after it
    bool m_dmenuMode = false;
    bool m_daemonMode = false;
    bool m_visible = false;
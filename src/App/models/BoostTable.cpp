@@ -0,0 +1,73 @@
+#include "BoostTable.h"
+#include "FilterWorker.h"
+#include "../utils/MRUTracker.h"
+#include <algorithm>
+
+int BoostTable::frecentRow(int row) const
+{
+    const int frecent = static_cast<int>(ranked.size());
+    if (row < frecent) return ranked[row];
+
+    // The n-th item without a boost, in corpus order: the smallest index x
+    // with x - (boosted items <= x) == n. Converges in a few steps.
+    const int n = row - frecent;
+    int index = n;
+    while (true) {
+        const int skipped = static_cast<int>(std::upper_bound(boostedSorted.begin(), boostedSorted.end(), index)
+                                             - boostedSorted.begin());
+        if (index == n + skipped) return index;
+        index = n + skipped;
+    }
+}
+
+namespace {
+
+// Same owner, not just the same address
+template <typename T>
+bool sameOwner(const std::weak_ptr<T>& a, const std::shared_ptr<T>& b)
+{
+    return !a.owner_before(b) && !b.owner_before(a);
+}
+
+} // namespace
+
+bool BoostTable::isCurrent(const std::shared_ptr<const FilterCorpus>& corpus,
+                           const std::shared_ptr<const RankingContext>& ranking, qint64 now) const
+{
+    return sameOwner(this->corpus, corpus) && sameOwner(this->ranking, ranking) &&
+           historyVersion == MRUTracker::instance().version() && now < validUntil;
+}
+
+std::shared_ptr<const BoostTable> BoostTable::build(const std::shared_ptr<const FilterCorpus>& corpusPtr,
+                                                    const std::shared_ptr<const RankingContext>& rankingPtr,
+                                                    qint64 now)
+{
+    const FilterCorpus& corpus = *corpusPtr;
+    const RankingContext& ranking = *rankingPtr;
+    auto table = std::make_shared<BoostTable>();
+    auto& tracker = MRUTracker::instance();
+    table->corpus = corpusPtr;
+    table->ranking = rankingPtr;
+    table->historyVersion = tracker.version();
+    table->boosts.assign(corpus.items.size(), 0);
+
+    // History and pins are small; map them onto item indices
+    const QHash<quint64, int> history = tracker.boosts(now, &table->validUntil);
+    for (auto it = history.constBegin(); it != history.constEnd(); ++it) {
+        const int index = corpus.items.indexOfHash(it.key());
+        if (index >= 0) table->boosts[index] += it.value();
+    }
+    for (auto it = ranking.pinBoosts.constBegin(); it != ranking.pinBoosts.constEnd(); ++it) {
+        const int index = corpus.items.indexOf(it.key());
+        if (index >= 0) table->boosts[index] += it.value();
+    }
+
+    for (size_t i = 0; i < table->boosts.size(); ++i) {
+        if (table->boosts[i] > 0) table->boostedSorted.push_back(static_cast<int>(i));
+    }
+    table->ranked = table->boostedSorted;
+    std::stable_sort(table->ranked.begin(), table->ranked.end(), [&table](int a, int b) {
+        return table->boosts[a] > table->boosts[b];
+    });
+    return table;
+}
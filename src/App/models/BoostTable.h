@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QtGlobal>
+#include <memory>
+#include <vector>
+
+struct FilterCorpus;
+struct RankingContext;
+
+/**
+ * @struct BoostTable
+ * @brief MRU and pin boost of every item of a corpus, by item index.
+ *
+ * Built from MRUTracker::boosts() and the ranking context, so scoring adds
+ * a boost from a flat array instead of looking up history per match. The
+ * boosted items, best first, also order the empty-query view. Immutable;
+ * rebuilt when the history changes or a recency step passes.
+ */
+struct BoostTable {
+    /**
+     * Identity only, for isCurrent(). Weak references keep the control
+     * blocks alive, so a set allocated where a freed one lived never
+     * compares equal.
+     */
+    std::weak_ptr<const FilterCorpus> corpus;
+    std::weak_ptr<const RankingContext> ranking;
+    quint64 historyVersion = 0;
+    qint64 validUntil = 0;
+
+    std::vector<int> boosts;        /**< Per item index */
+    std::vector<int> ranked;        /**< Items with a boost, best first */
+    std::vector<int> boostedSorted; /**< The same items, by index */
+
+    /** @brief Item index of the @p row -th row of the empty-query view. */
+    int frecentRow(int row) const;
+
+    /** @brief Whether the table still describes @p corpus and @p ranking at @p now. */
+    bool isCurrent(const std::shared_ptr<const FilterCorpus>& corpus,
+                   const std::shared_ptr<const RankingContext>& ranking, qint64 now) const;
+
+    static std::shared_ptr<const BoostTable> build(const std::shared_ptr<const FilterCorpus>& corpus,
+                                                   const std::shared_ptr<const RankingContext>& ranking,
+                                                   qint64 now);
+};
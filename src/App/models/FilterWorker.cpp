@@ -0,0 +1,286 @@
+#include "FilterWorker.h"
+#include "../utils/FuzzyMatcher.h"
+#include <QSemaphore>
+#include <QThread>
+#include <algorithm>
+#include <iterator>
+#include <queue>
+
+namespace {
+    using Match = FilterWorker::Match;
+    using MatchList = FilterWorker::MatchList;
+
+    // How many candidates to score between two cancellation checks
+    constexpr int CancelCheckInterval = 1024;
+    // Smallest chunk worth handing to another thread
+    constexpr size_t MinParallelChunk = 8192;
+
+    bool byScore(const Match& a, const Match& b)
+    {
+        return a.score > b.score;
+    }
+
+    // Threads for parallel chunks, separate from the icon loaders' global pool
+    QThreadPool& scoringPool()
+    {
+        static QThreadPool pool;
+        return pool;
+    }
+
+    /**
+     * Read-only state of one scoring pass. Every method is const and
+     * scoring allocates nothing but the output entries, so chunks of the
+     * same pass can be scored from several threads at once.
+     */
+    class Scorer
+    {
+    public:
+        Scorer(const FilterWorker::Job& job, const std::atomic<quint64>* generation)
+            : m_job(job)
+            , m_corpus(*job.corpus)
+            , m_boosts(job.boosts->boosts)
+            , m_generation(generation)
+            // Fold the query once; item keys were folded when the corpus was built
+            , m_query(FuzzyMatcher::foldQuery(job.query))
+            , m_queryMask(SearchIndex::maskOf(m_query.folded.constData(),
+                                              static_cast<int>(m_query.folded.size())))
+        {
+        }
+
+        bool superseded() const
+        {
+            return m_generation && m_generation->load(std::memory_order_relaxed) != m_job.generation;
+        }
+
+        /** Greedy-scores candidates [begin, end) into @p out, unordered. */
+        bool scoreRange(size_t begin, size_t end, MatchList& out) const
+        {
+            const FilterWorker::MatchList* candidates = m_job.candidates.get();
+
+            for (size_t i = begin; i < end; ++i) {
+                if ((i - begin) % CancelCheckInterval == 0 && superseded()) return false;
+
+                // When refining, only the matches of the shorter query can still match
+                const int index = candidates ? (*candidates)[i].index : static_cast<int>(i);
+                scoreItem(index, out);
+            }
+            return true;
+        }
+
+        /** Replaces the greedy score and field of @p match with the optimal ones. */
+        void rescoreOptimal(Match& match) const
+        {
+            int bestScore = 0;
+            int field = bestField(match.index, &FuzzyMatcher::scoreOptimal, bestScore);
+            if (field < 0) return; // Unreachable: greedy matched this item
+            match.field = field;
+            match.score = bestScore + m_boosts[match.index];
+        }
+
+    private:
+        void scoreItem(int index, MatchList& out) const
+        {
+            // Prefilter: some query character occurs in none of the fields
+            if ((m_corpus.index.itemMask(index) & m_queryMask) != m_queryMask) return;
+
+            // Try matching against primary, secondary, id, keywords, and categories
+            int bestScore = 0;
+            int field = bestField(index, &FuzzyMatcher::scoreFolded, bestScore);
+            if (field < 0) return;
+
+            // MRU and [RFC-004] pin boosts on top of the fuzzy score
+            out.push_back({index, bestScore + m_boosts[index], field});
+        }
+
+        // Best field score of @p index, ties going to the earlier field (primary
+        // takes precedence). Returns the field, or -1 if nothing matched.
+        template <typename MatchFn>
+        int bestField(int index, MatchFn matchFn, int& bestScore) const
+        {
+            int best = -1;
+            bestScore = 0;
+            for (int f = 0; f < SearchIndex::FieldCount; ++f) {
+                const auto field = static_cast<SearchIndex::Field>(f);
+                if ((m_corpus.index.fieldMask(index, field) & m_queryMask) != m_queryMask) continue;
+
+                int score = matchFn(m_query, m_corpus.index.key(index, field));
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = f;
+                }
+            }
+            return best;
+        }
+
+        const FilterWorker::Job& m_job;
+        const FilterCorpus& m_corpus;
+        const std::vector<int>& m_boosts;
+        const std::atomic<quint64>* m_generation;
+        const FuzzyMatcher::FoldedQuery m_query;
+        const quint64 m_queryMask;
+    };
+
+    /**
+     * Concatenates the chunk results into @p out so that its first
+     * @p headSize entries are the overall best, in order. Every part is
+     * expected to have its own best-first head of that size already.
+     */
+    void mergeHeads(std::vector<MatchList>& parts, size_t headSize, MatchList& out)
+    {
+        size_t total = 0;
+        for (const auto& part : parts) total += part.size();
+        out.clear();
+        out.reserve(total);
+
+        if (parts.size() == 1) {
+            out = std::move(parts.front());
+            return;
+        }
+
+        // K-way merge of the heads: (score, part) with the best score on top
+        std::vector<size_t> taken(parts.size(), 0);
+        std::priority_queue<std::pair<int, size_t>> heads;
+        for (size_t p = 0; p < parts.size(); ++p) {
+            if (!parts[p].empty()) heads.push({parts[p].front().score, p});
+        }
+        while (out.size() < headSize && !heads.empty()) {
+            const size_t p = heads.top().second;
+            heads.pop();
+            out.push_back(std::move(parts[p][taken[p]++]));
+            if (taken[p] < std::min(parts[p].size(), headSize)) {
+                heads.push({parts[p][taken[p]].score, p});
+            }
+        }
+
+        // Whatever the merge did not take stays unordered behind the head
+        for (size_t p = 0; p < parts.size(); ++p) {
+            std::move(parts[p].begin() + taken[p], parts[p].end(), std::back_inserter(out));
+        }
+    }
+}
+
+FilterWorker::FilterWorker(QObject *parent)
+    : QObject(parent)
+{
+    // A single thread: jobs never overlap, newer ones just supersede older ones
+    m_pool.setMaxThreadCount(1);
+}
+
+FilterWorker::~FilterWorker()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+void FilterWorker::submit(Job job)
+{
+    job.generation = ++m_generation;
+    m_pending = std::move(job);
+    if (!m_running) {
+        startNext();
+    }
+}
+
+void FilterWorker::cancel()
+{
+    ++m_generation;
+    m_pending.reset();
+}
+
+void FilterWorker::startNext()
+{
+    if (!m_pending) return;
+
+    auto job = std::make_shared<Job>(std::move(*m_pending));
+    m_pending.reset();
+    m_running = true;
+
+    m_pool.start([this, job]() {
+        auto matches = std::make_shared<MatchList>();
+        bool complete = score(*job, *matches, &m_generation);
+
+        QMetaObject::invokeMethod(this, [this, job, matches, complete]() {
+            m_running = false;
+            if (complete && job->generation == m_generation.load() && m_handler) {
+                m_handler(*job, matches);
+            }
+            startNext();
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool FilterWorker::score(const Job& job, MatchList& out, const std::atomic<quint64>* generation)
+{
+    const Scorer scorer(job, generation);
+    const size_t count = job.candidates ? job.candidates->size() : job.corpus->items.size();
+    const size_t topK = static_cast<size_t>(std::max(job.topK, 0));
+    const bool optimal = (job.ranking->algorithm == FuzzyMatcher::Optimal);
+
+    // Each chunk orders this many of its best matches; with the optimal
+    // scorer that is the whole window that gets rescored afterwards
+    const size_t headSize = optimal ? topK * OptimalRescoreFactor : topK;
+
+    int chunks = 1;
+    const int threshold = job.ranking->parallelThreshold;
+    if (threshold > 0 && count >= static_cast<size_t>(threshold)) {
+        chunks = std::clamp(static_cast<int>(count / MinParallelChunk), 1, QThread::idealThreadCount());
+    }
+
+    std::vector<MatchList> parts(chunks);
+    std::atomic<bool> complete{true};
+    auto scoreChunk = [&](int chunk) {
+        const size_t begin = count * chunk / chunks;
+        const size_t end = count * (chunk + 1) / chunks;
+        MatchList& part = parts[chunk];
+        if (!scorer.scoreRange(begin, end, part)) {
+            complete = false;
+            return;
+        }
+        const size_t head = std::min(part.size(), headSize);
+        std::partial_sort(part.begin(), part.begin() + head, part.end(), byScore);
+    };
+
+    if (chunks == 1) {
+        scoreChunk(0);
+    } else {
+        QSemaphore done;
+        for (int chunk = 1; chunk < chunks; ++chunk) {
+            scoringPool().start([&scoreChunk, &done, chunk]() {
+                scoreChunk(chunk);
+                done.release();
+            });
+        }
+        scoreChunk(0);
+        done.acquire(chunks - 1);
+    }
+
+    if (!complete || scorer.superseded()) return false;
+
+    mergeHeads(parts, headSize, out);
+
+    if (optimal) {
+        // Rescore the best greedy candidates with the DP scorer. It never
+        // scores below greedy, so they all stay ahead of the untouched rest.
+        const size_t window = std::min(out.size(), headSize);
+        for (size_t i = 0; i < window; ++i) {
+            scorer.rescoreOptimal(out[i]);
+        }
+
+        // Top-K by score descending; only the visible window needs an order
+        std::partial_sort(out.begin(), out.begin() + std::min(window, topK), out.begin() + window, byScore);
+    }
+    return true;
+}
+
+QVector<int> FilterWorker::positions(const FilterCorpus& corpus, const FuzzyMatcher::FoldedQuery& query,
+                                     FuzzyMatcher::Algorithm algorithm, const Match& match)
+{
+    QVector<int> result;
+    const auto key = corpus.index.key(match.index, static_cast<SearchIndex::Field>(match.field));
+    if (algorithm == FuzzyMatcher::Optimal) {
+        FuzzyMatcher::matchOptimal(query, key, result);
+    } else {
+        FuzzyMatcher::matchFolded(query, key, result);
+    }
+    return result;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "BoostTable.h"
+#include "ItemStore.h"
+#include "RankingContext.h"
+#include "SearchIndex.h"
+#include "../utils/FuzzyMatcher.h"
+
+/**
+ * @struct FilterCorpus
+ * @brief An item set and its search index. Immutable once published, so
+ * the GUI thread and the filter thread can share it without locking.
+ */
+struct FilterCorpus {
+    ItemStore items;
+    SearchIndex index;
+};
+
+/**
+ * @class FilterWorker
+ * @brief Scores filter queries on a background thread.
+ *
+ * One query is scored at a time. Submitting a query supersedes the one in
+ * flight (it stops at its next cancellation check) and replaces any query
+ * still waiting, so a burst of keystrokes collapses into the newest query.
+ * Results are delivered on the thread that owns the worker, and only if no
+ * newer query was submitted in the meantime.
+ */
+class FilterWorker : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief A matched item: index into the corpus plus its ranking data.
+     *
+     * Scoring records no highlight positions; positions() works them out
+     * for the few matches that are actually displayed.
+     */
+    struct Match {
+        int index;
+        int score;
+        int field;  /**< SearchIndex::Field that scored best */
+    };
+    using MatchList = std::vector<Match>;
+
+    /** @brief Everything needed to score one query, resolved on the GUI thread. */
+    struct Job {
+        quint64 generation = 0;
+        QString query;
+        std::shared_ptr<const FilterCorpus> corpus;
+        /** Pins, aliases (resolved on publish, not scored), algorithm, parallelism */
+        std::shared_ptr<const RankingContext> ranking;
+        /** MRU + pin boost per item index, built for this corpus and ranking */
+        std::shared_ptr<const BoostTable> boosts;
+        /** Matches of a shorter prefix of the query; null means score everything */
+        std::shared_ptr<const MatchList> candidates;
+        /** Only this many best matches are sorted, the rest stay unordered */
+        int topK = 0;
+    };
+
+    /** @brief The optimal scorer rescores this many pages of the best greedy candidates. */
+    static constexpr int OptimalRescoreFactor = 4;
+    /** @brief Default for general.parallel_threshold. */
+    static constexpr int DefaultParallelThreshold = 50000;
+
+    using ResultHandler = std::function<void(const Job&, std::shared_ptr<const MatchList>)>;
+
+    explicit FilterWorker(QObject *parent = nullptr);
+    ~FilterWorker();
+
+    /** @brief Sets the callback receiving the newest completed result. */
+    void setResultHandler(ResultHandler handler) { m_handler = std::move(handler); }
+
+    /** @brief Queues @p job for background scoring, superseding earlier jobs. */
+    void submit(Job job);
+
+    /** @brief Drops the queued job and invalidates the one in flight. */
+    void cancel();
+
+    /**
+     * @brief Scores @p job on the calling thread into @p out.
+     *
+     * The first @c job.topK entries of @p out are the best matches in
+     * descending score order; the remainder is left unordered for the model
+     * to select from page by page (see LauncherModel::fetchMore()).
+     *
+     * When @p generation is given, scoring stops early and returns false as
+     * soon as it no longer equals the job's generation.
+     *
+     * Above the ranking context's parallelThreshold candidates the work is
+     * split into chunks scored on a shared pool, each keeping its own
+     * best-first head; the heads are merged at the end.
+     */
+    static bool score(const Job& job, MatchList& out, const std::atomic<quint64>* generation = nullptr);
+
+    /** @brief Highlight positions of @p match for the folded @p query. */
+    static QVector<int> positions(const FilterCorpus& corpus, const FuzzyMatcher::FoldedQuery& query,
+                                  FuzzyMatcher::Algorithm algorithm, const Match& match);
+
+private:
+    void startNext();
+
+    QThreadPool m_pool;
+    std::atomic<quint64> m_generation{0};
+    std::optional<Job> m_pending;
+    bool m_running = false;
+    ResultHandler m_handler;
+};
@@ -0,0 +1,80 @@
+#include "ItemStore.h"
+
+static_assert(sizeof(ItemStore::Record) == 32, "Records are meant to stay compact");
+
+ItemStore::ItemStore()
+    : m_spans{{0, 0}}
+{
+}
+
+ItemStore::ItemStore(std::vector<LauncherItem> items)
+    : ItemStore()
+{
+    // Interned against the provider's strings first; the arena is only
+    // laid out once the total size is known
+    QHash<QString, StringId> ids;
+    std::vector<const QString*> strings{nullptr};
+    ids.insert(QString(), 0);
+    qsizetype total = 0;
+
+    m_records.reserve(items.size());
+    m_indexByHash.reserve(static_cast<qsizetype>(items.size()));
+    for (const LauncherItem& item : items) {
+        Record record;
+        for (int f = 0; f < FieldCount; ++f) {
+            const QString& text = field(item, static_cast<Field>(f));
+            auto it = ids.constFind(text);
+            if (it == ids.constEnd()) {
+                it = ids.insert(text, static_cast<StringId>(strings.size()));
+                strings.push_back(&text);
+                total += text.size();
+            }
+            record.fields[f] = *it;
+        }
+        record.flags = (item.terminal ? Terminal : 0u) | (item.selected ? Selected : 0u);
+
+        // Duplicate ids resolve to the first item, like a front-to-back search
+        const quint64 hash = idHash(item.id);
+        if (!m_indexByHash.contains(hash)) {
+            m_indexByHash.insert(hash, static_cast<int>(m_records.size()));
+        }
+        m_records.push_back(record);
+    }
+
+    m_arena.reserve(total);
+    m_spans.reserve(strings.size());
+    for (size_t i = 1; i < strings.size(); ++i) {
+        m_spans.push_back({static_cast<quint32>(m_arena.size()), static_cast<quint32>(strings[i]->size())});
+        m_arena.append(*strings[i]);
+    }
+}
+
+LauncherItem ItemStore::item(int index) const
+{
+    LauncherItem item;
+    item.id = text(index, Id).toString();
+    item.primary = text(index, Primary).toString();
+    item.secondary = text(index, Secondary).toString();
+    item.exec = text(index, Exec).toString();
+    item.iconKey = text(index, IconKey).toString();
+    item.keywords = text(index, Keywords).toString();
+    item.categories = text(index, Categories).toString();
+    item.terminal = hasFlag(index, Terminal);
+    item.selected = hasFlag(index, Selected);
+    return item;
+}
+
+const QString& ItemStore::field(const LauncherItem& item, Field field)
+{
+    switch (field) {
+    case Id: return item.id;
+    case Primary: return item.primary;
+    case Secondary: return item.secondary;
+    case Exec: return item.exec;
+    case IconKey: return item.iconKey;
+    case Keywords: return item.keywords;
+    case Categories: break;
+    case FieldCount: break;
+    }
+    return item.categories;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <vector>
+#include "LauncherItem.h"
+#include "../utils/IdHash.h"
+
+/**
+ * @class ItemStore
+ * @brief Owns an item set as compact records over one string arena.
+ *
+ * Providers build many strings with the same value independently (icon
+ * keys like "application-x-executable", "SSH Host", categories and
+ * keywords repeated on every desktop action). The store interns every
+ * distinct string once into a single character arena, and each item
+ * becomes a Record of string-table indices plus a flags word: 32 bytes
+ * instead of a LauncherItem's seven QStrings and a vector.
+ *
+ * Everything downstream (search index, displayed rows, IPC replies) refers
+ * to items by their index in the store and reads fields as views into the
+ * arena. Immutable once built, so the filter thread can share it.
+ */
+class ItemStore
+{
+public:
+    /** @brief Index into the string table; 0 is the empty string. */
+    using StringId = quint32;
+
+    enum Field {
+        Id,
+        Primary,
+        Secondary,
+        Exec,
+        IconKey,
+        Keywords,
+        Categories,
+        FieldCount
+    };
+
+    enum Flag : quint32 {
+        Terminal = 1u << 0,
+        Selected = 1u << 1
+    };
+
+    struct Record {
+        StringId fields[FieldCount];
+        quint32 flags;
+    };
+
+    ItemStore();
+    /** @brief Interns @p items; the vector and its strings are released afterwards. */
+    explicit ItemStore(std::vector<LauncherItem> items);
+
+    size_t size() const { return m_records.size(); }
+    bool empty() const { return m_records.empty(); }
+    const Record& record(int index) const { return m_records[index]; }
+
+    /** @brief @p field of the item at @p index; valid as long as the store. */
+    QStringView text(int index, Field field) const { return string(m_records[index].fields[field]); }
+    bool hasFlag(int index, Flag flag) const { return m_records[index].flags & flag; }
+    /** @brief A standalone copy of the item at @p index. */
+    LauncherItem item(int index) const;
+
+    /** @brief Text of string @p id. */
+    QStringView string(StringId id) const
+    {
+        const Span& span = m_spans[id];
+        return QStringView(m_arena.constData() + span.start, span.length);
+    }
+    /** @brief Where string @p id starts in arena(). */
+    quint32 stringOffset(StringId id) const { return m_spans[id].start; }
+    /** @brief Every distinct string, back to back. */
+    const QString& arena() const { return m_arena; }
+    /** @brief Number of distinct strings, the empty one included. */
+    int stringCount() const { return static_cast<int>(m_spans.size()); }
+
+    /** @brief Index of the first item with @p id, or -1. */
+    int indexOf(QStringView id) const
+    {
+        const int index = indexOfHash(idHash(id));
+        return index >= 0 && text(index, Id) == id ? index : -1;
+    }
+    /** @brief Index of the first item whose id hashes to @p hash, or -1. */
+    int indexOfHash(quint64 hash) const { return m_indexByHash.value(hash, -1); }
+
+    /** @brief Text of @p field in a LauncherItem, as the store keeps it. */
+    static const QString& field(const LauncherItem& item, Field field);
+
+private:
+    struct Span {
+        quint32 start;
+        quint32 length;
+    };
+
+    QString m_arena;
+    std::vector<Span> m_spans;          /**< StringId -> range of m_arena */
+    std::vector<Record> m_records;
+    QHash<quint64, int> m_indexByHash;  /**< idHash() -> index */
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @struct LauncherItem
+ * @brief Represents a single entry in the launcher (App, Command, or Window).
+ */
+struct LauncherItem {
+    QString id;                 /**< Unique identifier */
+    QString primary;            /**< Main text (App name, Window title) */
+    QString secondary;          /**< Subtext (Description, app_id) */
+    QString exec;               /**< Command to execute (if applicable) */
+    QString iconKey;            /**< Icon name or path */
+    QString keywords;           /**< Search keywords from .desktop file */
+    QString categories;         /**< Categories from .desktop file */
+    bool selected = false;      /**< Selection state */
+    bool terminal = false;      /**< Whether to run in terminal */
+    QVector<int> matchPositions; /**< Indices of characters matched by fuzzy filter */
+};
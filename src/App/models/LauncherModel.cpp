@@ -1,40 +1,88 @@
 #include "LauncherModel.h"
 #include "../providers/DesktopFileLoader.h"
-#include "../utils/FuzzyMatcher.h"
-#include "../utils/FuzzyMatcher.h"
-#include "../utils/MRUTracker.h"
 #include "../utils/Config.h"
+#include "../utils/Profiler.h"
+#include <QDateTime>
+#include <QHash>
 #include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Marks a longest strictly increasing subsequence of @p values.
+ *
+ * Rows on it keep their place during a diff; only the others are moved.
+ */
+std::vector<bool> longestIncreasing(const std::vector<int>& values)
+{
+    std::vector<int> tails;                 // Index of the smallest tail per length
+    std::vector<int> previous(values.size(), -1);
+    for (int i = 0; i < static_cast<int>(values.size()); ++i) {
+        auto it = std::lower_bound(tails.begin(), tails.end(), values[i],
+                                   [&values](int index, int value) { return values[index] < value; });
+        if (it != tails.begin()) previous[i] = *(it - 1);
+        if (it == tails.end()) tails.push_back(i);
+        else *it = i;
+    }
+
+    std::vector<bool> member(values.size(), false);
+    for (int i = tails.empty() ? -1 : tails.back(); i >= 0; i = previous[i]) {
+        member[i] = true;
+    }
+    return member;
+}
+
+/** @brief Whether a row showing item @p a would look the same showing @p b. */
+template <typename Row>
+bool sameDisplay(const Row& a, const Row& b)
+{
+    return a.text(ItemStore::Primary) == b.text(ItemStore::Primary) &&
+           a.text(ItemStore::Secondary) == b.text(ItemStore::Secondary) &&
+           a.text(ItemStore::IconKey) == b.text(ItemStore::IconKey) &&
+           a.text(ItemStore::Exec) == b.text(ItemStore::Exec) &&
+           a.store->record(a.index).flags == b.store->record(b.index).flags;
+}
+
+} // namespace
 
 LauncherModel::LauncherModel(QObject *parent)
     : QAbstractListModel(parent)
+    , m_corpus(std::make_shared<FilterCorpus>())
 {
     // Items are now loaded in main.cpp to support providers/overrides better
+    m_worker.setResultHandler([this](const FilterWorker::Job& job,
+                                     std::shared_ptr<const FilterWorker::MatchList> matches) {
+        // Results scored against an item set that has since been replaced are stale
+        if (job.corpus != m_corpus) return;
+        publish(job, std::move(matches), true);
+    });
 }
 
 int LauncherModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
         return 0;
-    return static_cast<int>(m_displayedItems.size());
+    return static_cast<int>(m_rows.size());
 }
 
 QVariant LauncherModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= static_cast<int>(m_displayedItems.size()))
+    if (!index.isValid() || index.row() >= rowCount())
         return QVariant();
 
-    const auto &item = m_displayedItems[index.row()];
+    const Row& row = m_rows[index.row()];
 
     switch (role) {
-    case IdRole: return item.id;
-    case PrimaryRole: return item.primary;
-    case SecondaryRole: return item.secondary;
-    case IconKeyRole: return item.iconKey;
-    case SelectedRole: return item.selected;
-    case TerminalRole: return item.terminal;
-    case ExecRole: return item.exec;
-    case MatchPositionsRole: return QVariant::fromValue(item.matchPositions);
+    case IdRole: return row.text(ItemStore::Id).toString();
+    case PrimaryRole: return row.text(ItemStore::Primary).toString();
+    case SecondaryRole: return row.text(ItemStore::Secondary).toString();
+    case IconKeyRole: return row.text(ItemStore::IconKey).toString();
+    case SelectedRole: return row.store->hasFlag(row.index, ItemStore::Selected);
+    case TerminalRole: return row.store->hasFlag(row.index, ItemStore::Terminal);
+    case ExecRole: return row.text(ItemStore::Exec).toString();
+    case MatchPositionsRole: return QVariant::fromValue(positionsAt(index.row()));
     default: return QVariant();
     }
 }
@@ -53,168 +101,461 @@ QHash<int, QByteArray> LauncherModel::roleNames() const
     return roles;
 }
 
-void LauncherModel::setItems(const std::vector<LauncherItem>& items)
+bool LauncherModel::canFetchMore(const QModelIndex &parent) const
 {
-    qDebug() << "LauncherModel::setItems called with" << items.size() << "items";
-    beginResetModel();
-    m_allItems = items;
-    m_displayedItems = items;
-    endResetModel();
+    return !parent.isValid() && !m_applyingRows && m_loadedRows < availableRows();
+}
+
+void LauncherModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || m_applyingRows)
+        return;
+
+    const int count = std::min(PageSize, availableRows() - m_loadedRows);
+    if (count <= 0)
+        return;
+
+    const int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+    if (m_matches) {
+        selectMatchRows(count);
+    }
+    for (int i = 0; i < count; ++i) {
+        m_rows.push_back(corpusRow(m_loadedRows + i));
+    }
+    m_loadedRows += count;
+    endInsertRows();
     emit countChanged();
-    qDebug() << "LauncherModel::setItems finished. Display count:" << m_displayedItems.size();
 }
 
-#include "../utils/Profiler.h"
+int LauncherModel::availableRows() const
+{
+    return static_cast<int>(m_matches ? m_matches->size() : m_corpus->items.size());
+}
+
+void LauncherModel::selectMatchRows(int count)
+{
+    const auto& matches = *m_matches;
+
+    // The worker already sorted the first page; later pages are picked
+    // from the remaining slots only when the view scrolls that far.
+    if (m_unloadedSlots.empty() && m_unloadedOffset == 0) {
+        m_unloadedSlots.reserve(matches.size() - m_matchRows.size());
+        for (size_t slot = m_matchRows.size(); slot < matches.size(); ++slot) {
+            m_unloadedSlots.push_back(static_cast<int>(slot));
+        }
+    }
+
+    auto begin = m_unloadedSlots.begin() + m_unloadedOffset;
+    auto middle = begin + std::min<size_t>(count, m_unloadedSlots.size() - m_unloadedOffset);
+    std::partial_sort(begin, middle, m_unloadedSlots.end(), [&matches](int a, int b) {
+        return matches[a].score > matches[b].score;
+    });
+    m_matchRows.insert(m_matchRows.end(), begin, middle);
+    m_unloadedOffset += middle - begin;
+}
+
+LauncherModel::Row LauncherModel::corpusRow(int loaded) const
+{
+    if (m_matches) {
+        const auto& match = (*m_matches)[m_matchRows[loaded]];
+        return {&m_corpus->items, match.index, &match, m_highlight.get()};
+    }
+    return {&m_corpus->items, m_frecency->frecentRow(loaded)};
+}
+
+std::vector<LauncherModel::Row> LauncherModel::buildRows() const
+{
+    std::vector<Row> rows;
+    rows.reserve(m_injected.size() + m_loadedRows);
+    for (int i = 0; i < static_cast<int>(m_injected.size()); ++i) {
+        rows.push_back({&m_injected, i});
+    }
+    for (int i = 0; i < m_loadedRows; ++i) {
+        rows.push_back(corpusRow(i));
+    }
+    return rows;
+}
+
+void LauncherModel::applyRows(std::vector<Row> rows)
+{
+    m_applyingRows = true;
+    const int newCount = static_cast<int>(rows.size());
+
+    // Pair every displayed row with an unclaimed new row of the same id
+    QHash<QStringView, QVector<int>> newRowsById;
+    for (int j = 0; j < newCount; ++j) {
+        newRowsById[rows[j].text(ItemStore::Id)].append(j);
+    }
+    QHash<QStringView, int> claimed;
+    std::vector<int> targets(m_rows.size(), -1);
+    std::vector<bool> kept(newCount, false);
+    for (size_t i = 0; i < m_rows.size(); ++i) {
+        const QStringView id = m_rows[i].text(ItemStore::Id);
+        auto it = newRowsById.constFind(id);
+        if (it == newRowsById.constEnd()) continue;
+        int& used = claimed[id];
+        if (used < it->size()) {
+            targets[i] = it->at(used++);
+            kept[targets[i]] = true;
+        }
+    }
+
+    // 1. Remove rows that are gone, back to front in contiguous runs
+    for (int end = static_cast<int>(m_rows.size()); end > 0;) {
+        if (targets[end - 1] >= 0) {
+            --end;
+            continue;
+        }
+        int begin = end - 1;
+        while (begin > 0 && targets[begin - 1] < 0) --begin;
+        beginRemoveRows(QModelIndex(), begin, end - 1);
+        m_rows.erase(m_rows.begin() + begin, m_rows.begin() + end);
+        targets.erase(targets.begin() + begin, targets.begin() + end);
+        endRemoveRows();
+        end = begin;
+    }
+
+    // 2. Rows on a longest increasing run of targets stay put; every other
+    //    row moves in front of its first placed successor.
+    std::vector<bool> placed(newCount, false);
+    std::vector<int> pending;
+    const auto stay = longestIncreasing(targets);
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (stay[i]) placed[targets[i]] = true;
+        else pending.push_back(targets[i]);
+    }
+    std::sort(pending.begin(), pending.end());
+    for (int target : pending) {
+        const int size = static_cast<int>(targets.size());
+        const int src = static_cast<int>(std::find(targets.begin(), targets.end(), target) - targets.begin());
+        int dest = size;
+        for (int k = 0; k < size; ++k) {
+            if (placed[targets[k]] && targets[k] > target) {
+                dest = k;
+                break;
+            }
+        }
+        if (dest != src && dest != src + 1) {
+            const int to = dest > src ? dest - 1 : dest;
+            beginMoveRows(QModelIndex(), src, src, QModelIndex(), dest);
+            Row row = std::move(m_rows[src]);
+            m_rows.erase(m_rows.begin() + src);
+            m_rows.insert(m_rows.begin() + to, std::move(row));
+            targets.erase(targets.begin() + src);
+            targets.insert(targets.begin() + to, target);
+            endMoveRows();
+        }
+        placed[target] = true;
+    }
+
+    // 3. Insert new rows; surviving rows are in order now, so row j is slot j
+    for (int j = 0; j < newCount;) {
+        if (kept[j]) {
+            ++j;
+            continue;
+        }
+        int end = j + 1;
+        while (end < newCount && !kept[end]) ++end;
+        beginInsertRows(QModelIndex(), j, end - 1);
+        m_rows.insert(m_rows.begin() + j, rows.begin() + j, rows.begin() + end);
+        endInsertRows();
+        j = end;
+    }
+
+    // 4. Refresh surviving rows whose item or highlight changed
+    enum Change { Unchanged, Positions, Everything };
+    std::vector<Change> changes(newCount, Unchanged);
+    for (int j = 0; j < newCount; ++j) {
+        if (!kept[j]) continue;
+        const Row& before = m_rows[j];
+        const Row& after = rows[j];
+        // A refreshed set brings new copies of mostly unchanged items
+        const bool sameItem = before.store == after.store && before.index == after.index;
+        if (!sameItem && !sameDisplay(before, after)) {
+            changes[j] = Everything;
+        } else if (before.match || after.match) {
+            // Positions are recomputed on demand, so compare what they derive from
+            const bool same = before.match && after.match &&
+                              before.match->field == after.match->field &&
+                              before.highlight->algorithm == after.highlight->algorithm &&
+                              before.highlight->query.original == after.highlight->query.original;
+            if (!same) changes[j] = Positions;
+        }
+    }
+    m_rows = std::move(rows);
+    for (int j = 0; j < newCount;) {
+        const Change change = changes[j];
+        int end = j + 1;
+        while (end < newCount && changes[end] == change) ++end;
+        if (change == Everything) {
+            emit dataChanged(index(j), index(end - 1));
+        } else if (change == Positions) {
+            emit dataChanged(index(j), index(end - 1), {MatchPositionsRole});
+        }
+        j = end;
+    }
+
+    m_applyingRows = false;
+}
+
+const QVector<int>& LauncherModel::positionsAt(int row) const
+{
+    static const QVector<int> none;
+    const Row& shown = m_rows[row];
+    if (!shown.match) return none;
+
+    if (!shown.positionsResolved) {
+        const Highlight& highlight = *shown.highlight;
+        shown.positions = FilterWorker::positions(*highlight.corpus, highlight.query,
+                                                  highlight.algorithm, *shown.match);
+        shown.positionsResolved = true;
+    }
+    return shown.positions;
+}
+
+int LauncherModel::loadRows(int limit)
+{
+    while (rowCount() < limit && canFetchMore(QModelIndex())) {
+        fetchMore(QModelIndex());
+    }
+    return std::min(limit, rowCount());
+}
+
+void LauncherModel::setItems(std::vector<LauncherItem> items)
+{
+    qDebug() << "LauncherModel::setItems called with" << items.size() << "items";
+    m_worker.cancel();
+
+    auto corpus = std::make_shared<FilterCorpus>();
+    corpus->items = ItemStore(std::move(items));
+    corpus->index.build(corpus->items);
+
+    // The displayed rows point into the previous set until showAll() is done
+    const auto previous = std::exchange(m_corpus, std::move(corpus));
+    m_query.clear();
+    showAll();
+    qDebug() << "LauncherModel::setItems finished. Display count:" << rowCount();
+}
+
+LauncherModel::PreparedItems LauncherModel::prepareItems(std::vector<LauncherItem> items,
+                                                         std::shared_ptr<const RankingContext> ranking)
+{
+    auto corpus = std::make_shared<FilterCorpus>();
+    corpus->items = ItemStore(std::move(items));
+    corpus->index.build(corpus->items);
+
+    PreparedItems prepared;
+    if (ranking) {
+        prepared.boosts = BoostTable::build(corpus, ranking, QDateTime::currentMSecsSinceEpoch());
+    }
+    prepared.corpus = std::move(corpus);
+    prepared.ranking = std::move(ranking);
+    return prepared;
+}
+
+void LauncherModel::replaceItems(PreparedItems prepared)
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_worker.cancel();
+
+    // The displayed rows point into the previous set until the diff is done
+    const auto previous = std::exchange(m_corpus, std::move(prepared.corpus));
+    m_filterCache.clear();
+    if (prepared.boosts && prepared.ranking == m_ranking) {
+        m_boosts = std::move(prepared.boosts);
+    }
+
+    if (m_query.isEmpty()) {
+        showAll(false);
+    } else {
+        // Refreshed sets are small (processes), so rescoring here beats a
+        // thread round trip that would let the old rows flash
+        FilterWorker::Job job = prepareJob(m_query);
+        auto matches = std::make_shared<FilterWorker::MatchList>();
+        FilterWorker::score(job, *matches);
+        publish(job, std::move(matches), true, false);
+    }
+
+    APP_PROFILE_POINT(timer, "Items replaced");
+}
 
 void LauncherModel::filter(const QString& query)
 {
     QElapsedTimer timer;
     timer.start();
     
-    qDebug() << "LauncherModel::filter called with:" << query << "Total Items:" << m_allItems.size();
-    beginResetModel();
+    qDebug() << "LauncherModel::filter called with:" << query << "Total Items:" << m_corpus->items.size();
+
+    // A synchronous filter supersedes anything still running in the background
+    m_worker.cancel();
+    m_query = query;
+
     if (query.isEmpty()) {
-        // Show all items when empty (both drun and run modes)
-        m_displayedItems = m_allItems;
+        showAll();
     } else {
-        // Fuzzy match and score all items
-        struct ScoredItem {
-            LauncherItem item;
-            int score;
-        };
-        
-        std::vector<ScoredItem> scoredItems;
-
-        // [RFC-004] Resolve Pins & Aliases
-        auto& config = Config::instance();
-        QStringList pins = config.getGlobalPins();
-        QMap<QString, QString> aliases = config.getGlobalAliases();
-
-        if (auto setOpt = config.getSet(m_setName)) {
-            // Per-set pins take precedence (prepend)
-            QStringList setPins = setOpt->pins;
-            setPins.append(pins); 
-            pins = setPins;
-
-            // Per-set aliases override global
-            auto setAliases = setOpt->aliases;
-            for (auto it = setAliases.begin(); it != setAliases.end(); ++it) {
-                aliases.insert(it.key(), it.value());
-            }
+        FilterWorker::Job job = prepareJob(query);
+        if (!m_filterCache.empty() && m_filterCache.back().query == query) {
+            // Backspace (or a repeated query): restore the cached result set
+            publish(job, m_filterCache.back().matches, false);
+        } else {
+            auto matches = std::make_shared<FilterWorker::MatchList>();
+            FilterWorker::score(job, *matches);
+            publish(job, std::move(matches), true);
         }
+    }
+    
+    APP_PROFILE_POINT(timer, "Filter completed");
+}
 
-        // [RFC-004] Alias Handling
-        if (aliases.contains(query)) {
-            QString target = aliases[query];
-            bool foundReal = false;
-            
-            // Try to find the real item
-            for (const auto& item : m_allItems) {
-                if (item.id == target) {
-                    scoredItems.push_back({item, 100000000}); // Massive boost
-                    foundReal = true;
-                    break;
-                }
-            }
+void LauncherModel::requestFilter(const QString& query)
+{
+    if (query.isEmpty() || static_cast<int>(m_corpus->items.size()) < AsyncFilterThreshold) {
+        filter(query);
+        return;
+    }
+    m_query = query;
 
-            // If not found, inject synthetic alias item
-            if (!foundReal) {
-                LauncherItem aliasItem;
-                aliasItem.id = "alias:" + query;
-                aliasItem.primary = target;
-                aliasItem.secondary = "Alias: " + query;
-                aliasItem.iconKey = "utilities-terminal"; // Generic icon
-                aliasItem.exec = target;
-                aliasItem.terminal = true; 
-                scoredItems.push_back({aliasItem, 100000000});
-            }
+    FilterWorker::Job job = prepareJob(query);
+    if (!m_filterCache.empty() && m_filterCache.back().query == query) {
+        m_worker.cancel();
+        publish(job, m_filterCache.back().matches, false);
+        return;
+    }
+
+    m_worker.submit(std::move(job));
+}
+
+void LauncherModel::showAll(bool newResults)
+{
+    // Show all items when empty (both drun and run modes), one page at a
+    // time, most frecent first
+    refreshBoosts();
+    const auto previousInjected = std::exchange(m_injected, {});
+    const auto previousMatches = std::exchange(m_matches, nullptr);
+    const auto previousHighlight = std::exchange(m_highlight, nullptr);
+    m_frecency = m_boosts;
+    m_matchRows.clear();
+    m_unloadedSlots.clear();
+    m_unloadedOffset = 0;
+    m_loadedRows = std::min(PageSize, availableRows());
+    m_filterCache.clear();
+    applyRows(buildRows());
+    emit countChanged();
+    if (newResults) emit resultsChanged();
+}
+
+void LauncherModel::refreshBoosts()
+{
+    if (!m_ranking) {
+        m_ranking = RankingContext::forSet(Config::instance().getDefaultSetName());
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m_boosts && m_boosts->isCurrent(m_corpus, m_ranking, now)) return;
+
+    m_boosts = BoostTable::build(m_corpus, m_ranking, now);
+    // Cached scores include the old boosts
+    m_filterCache.clear();
+}
+
+FilterWorker::Job LauncherModel::prepareJob(const QString& query)
+{
+    FilterWorker::Job job;
+    job.query = query;
+    job.corpus = m_corpus;
+    job.topK = PageSize;
+
+    // [RFC-004] Pins & aliases were resolved when the set was loaded
+    refreshBoosts();
+    job.ranking = m_ranking;
+    job.boosts = m_boosts;
+
+    // Incremental refinement: drop cached result sets this query no longer
+    // extends (backspace, edits in the middle, a completely new query).
+    while (!m_filterCache.empty() &&
+           !query.startsWith(m_filterCache.back().query, Qt::CaseInsensitive)) {
+        m_filterCache.pop_back();
+    }
+
+    if (!m_filterCache.empty()) {
+        job.candidates = m_filterCache.back().matches;
+    }
+    return job;
+}
+
+void LauncherModel::publish(const FilterWorker::Job& job,
+                            std::shared_ptr<const FilterWorker::MatchList> matches,
+                            bool remember, bool newResults)
+{
+    const QString& query = job.query;
+    const auto& allItems = m_corpus->items;
+
+    if (remember) {
+        if (static_cast<int>(m_filterCache.size()) >= MaxFilterCacheDepth) {
+            m_filterCache.erase(m_filterCache.begin());
         }
-        
-        for (const auto& item : m_allItems) {
-            // BUG FIX: Filter logic was skipping everything in 'run' mode incorrectly
-            // If in 'run' mode, we only want to skip if the item isn't a 'path' or 'run' item
-            // For now, let's keep it simple: just match everything in all modes.
-            
-            // Try matching against primary, secondary, id, keywords, and categories
-            auto primaryMatch = FuzzyMatcher::match(query, item.primary);
-            auto secondaryMatch = FuzzyMatcher::match(query, item.secondary);
-            auto idMatch = FuzzyMatcher::match(query, item.id);
-            auto keywordsMatch = FuzzyMatcher::match(query, item.keywords);
-            auto categoriesMatch = FuzzyMatcher::match(query, item.categories);
-            
-            int bestScore = std::max({
-                primaryMatch.score, 
-                secondaryMatch.score, 
-                idMatch.score, 
-                keywordsMatch.score,
-                categoriesMatch.score
-            });
-            
-            if (bestScore > 0) {
-                LauncherItem itemWithPositions = item;
-                // Store positions from the best match (primary takes precedence)
-                if (primaryMatch.score == bestScore) {
-                    itemWithPositions.matchPositions = primaryMatch.positions;
-                } else if (secondaryMatch.score == bestScore) {
-                    itemWithPositions.matchPositions = secondaryMatch.positions;
-                } else if (idMatch.score == bestScore) {
-                    itemWithPositions.matchPositions = idMatch.positions;
-                } else if (keywordsMatch.score == bestScore) {
-                    itemWithPositions.matchPositions = keywordsMatch.positions;
-                } else {
-                    itemWithPositions.matchPositions = categoriesMatch.positions;
-                }
-                
-                // Apply MRU boost
-                // Apply MRU boost (RFC-005 will refine this, currently simple add)
-                int mruBoost = MRUTracker::instance().getBoost(item.id);
-                int finalScore = bestScore + mruBoost;
-
-                // [RFC-004] Pin Boost
-                // Pins are prioritized by order.
-                int pinIndex = pins.indexOf(item.id);
-                if (pinIndex != -1) {
-                    // Base pin boost 500000 + prioritization based on list order
-                    finalScore += 500000 + ((pins.size() - pinIndex) * 1000);
-                }
-                
-                scoredItems.push_back({itemWithPositions, finalScore});
-            }
+        m_filterCache.push_back({query, matches});
+    }
+
+    // The displayed rows point into these until applyRows() is done
+    const auto previousInjected = std::exchange(m_injected, {});
+    const auto previousMatches = m_matches;
+    const auto previousHighlight = std::exchange(m_highlight, std::make_shared<Highlight>(
+        Highlight{m_corpus, FuzzyMatcher::foldQuery(query), job.ranking->algorithm}));
+    std::vector<LauncherItem> injected;
+
+    // [RFC-004] Alias Handling
+    // Alias hits outrank every scored match, so they always lead the list.
+    const auto alias = job.ranking->aliases.constFind(query);
+    if (alias != job.ranking->aliases.constEnd()) {
+        const QString& target = alias.value();
+
+        // Try to find the real item
+        const int realIndex = allItems.indexOf(target);
+        if (realIndex >= 0) {
+            injected.push_back(allItems.item(realIndex));
+        } else {
+            // If not found, inject synthetic alias item
+            LauncherItem aliasItem;
+            aliasItem.id = "alias:" + query;
+            aliasItem.primary = target;
+            aliasItem.secondary = "Alias: " + query;
+            aliasItem.iconKey = "utilities-terminal"; // Generic icon
+            aliasItem.exec = target;
+            aliasItem.terminal = true; 
+            injected.push_back(aliasItem);
         }
+    }
+    
+    // Expose the first page; the worker already sorted exactly that many
+    m_matches = std::move(matches);
+    m_loadedRows = std::min(PageSize, availableRows());
+    m_matchRows.resize(m_loadedRows);
+    std::iota(m_matchRows.begin(), m_matchRows.end(), 0);
+    m_unloadedSlots.clear();
+    m_unloadedOffset = 0;
+    
+    // Fallback: simple "Run command" if no matches
+    if (injected.empty() && m_matches->empty() && !query.trimmed().isEmpty() && m_fallbackEnabled) {
+        LauncherItem runItem;
+        runItem.id = "fallback:" + query;
+        runItem.primary = "Run '" + query + "' in terminal";
+        runItem.secondary = "Custom Command";
+        runItem.iconKey = "utilities-terminal";
         
-        // Sort by score descending
-        std::sort(scoredItems.begin(), scoredItems.end(), 
-                  [](const ScoredItem& a, const ScoredItem& b) {
-                      return a.score > b.score;
-                  });
-        
-        // Extract sorted items
-        m_displayedItems.clear();
-        for (const auto& scored : scoredItems) {
-            m_displayedItems.push_back(scored.item);
-        }
+        // Just pass the query as exec. The Controller's logic for terminal vs shell 
+        // depends on "TerminalRole". We want this to run in terminal usually?
+        // "run in terminal" implies TerminalRole = true.
+        runItem.exec = query; 
+        runItem.terminal = true; 
         
-        // Fallback: simple "Run command" if no matches
-        if (m_displayedItems.empty() && !query.trimmed().isEmpty() && m_fallbackEnabled) {
-            LauncherItem runItem;
-            runItem.id = "fallback:" + query;
-            runItem.primary = "Run '" + query + "' in terminal";
-            runItem.secondary = "Custom Command";
-            runItem.iconKey = "utilities-terminal";
-            
-            // Just pass the query as exec. The Controller's logic for terminal vs shell 
-            // depends on "TerminalRole". We want this to run in terminal usually?
-            // "run in terminal" implies TerminalRole = true.
-            runItem.exec = query; 
-            runItem.terminal = true; 
-            
-            runItem.selected = false;
-            m_displayedItems.push_back(runItem);
-        }
+        runItem.selected = false;
+        injected.push_back(runItem);
     }
-    endResetModel();
+    m_injected = ItemStore(std::move(injected));
+    applyRows(buildRows());
     emit countChanged();
-    
-    APP_PROFILE_POINT(timer, "Filter completed");
+    if (newResults) emit resultsChanged();
 }
-
@@ -2,28 +2,24 @@
 
 #include <QAbstractListModel>
 #include <QVector>
+#include <memory>
 #include <vector>
-
-/**
- * @struct LauncherItem
- * @brief Represents a single entry in the launcher (App, Command, or Window).
- */
-struct LauncherItem {
-    QString id;                 /**< Unique identifier */
-    QString primary;            /**< Main text (App name, Window title) */
-    QString secondary;          /**< Subtext (Description, app_id) */
-    QString exec;               /**< Command to execute (if applicable) */
-    QString iconKey;            /**< Icon name or path */
-    QString keywords;           /**< Search keywords from .desktop file */
-    QString categories;         /**< Categories from .desktop file */
-    bool selected = false;      /**< Selection state */
-    bool terminal = false;      /**< Whether to run in terminal */
-    QVector<int> matchPositions; /**< Indices of characters matched by fuzzy filter */
-};
+#include "LauncherItem.h"
+#include "FilterWorker.h"
 
 /**
  * @class LauncherModel
  * @brief Qt ListModel providing data to the QML results list.
+ *
+ * Rows are materialized lazily: the model exposes one page of results and
+ * hands out further pages through canFetchMore()/fetchMore() as the view
+ * scrolls. Items live as compact records in an ItemStore; rows and matches
+ * refer to them by index, so a keystroke never copies items. With an empty
+ * query, recently used and pinned items come first (see BoostTable).
+ *
+ * A new result set is applied as a row diff (removes, moves, inserts and
+ * dataChanged) rather than a model reset, so QML keeps the delegates and
+ * loaded icons of rows that survive a keystroke.
  */
 class LauncherModel : public QAbstractListModel
 {
@@ -51,11 +47,43 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
 
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
     /** @brief Populates the model with a new set of items. */
-    void setItems(const std::vector<LauncherItem>& items);
+    void setItems(std::vector<LauncherItem> items);
+
+    /** @brief An item set indexed for replaceItems(), off the GUI thread. */
+    struct PreparedItems {
+        std::shared_ptr<const FilterCorpus> corpus;
+        std::shared_ptr<const RankingContext> ranking; /**< The boosts were built for */
+        std::shared_ptr<const BoostTable> boosts;
+    };
+
+    /** @brief Indexes @p items and their boosts under @p ranking; safe on any thread. */
+    static PreparedItems prepareItems(std::vector<LauncherItem> items,
+                                      std::shared_ptr<const RankingContext> ranking);
+
+    /**
+     * @brief Swaps in a refreshed version of the current item set.
+     *
+     * Unlike setItems(), the current query stays applied and resultsChanged()
+     * is not emitted: rows are matched by id, so only rows whose content
+     * changed, appeared or went away are signalled and the view keeps its
+     * selection.
+     */
+    void replaceItems(PreparedItems prepared);
     
-    /** @brief Filters the internal item list based on a query string. */
+    /** @brief Filters the internal item list based on a query string (synchronous). */
     Q_INVOKABLE void filter(const QString& query);
+
+    /**
+     * @brief Filters without blocking the caller on large item sets.
+     *
+     * Sets above AsyncFilterThreshold are scored on the FilterWorker thread;
+     * superseded queries are abandoned and only the newest result is shown.
+     */
+    Q_INVOKABLE void requestFilter(const QString& query);
     
     /** @brief Sets the provider mode (drun, run, window). */
     void setShowMode(const QString& mode) { m_showMode = mode; }
@@ -63,19 +91,115 @@ public:
     /** @brief Enable/Disable fallback "Run..." item */
     void setFallbackEnabled(bool enabled) { m_fallbackEnabled = enabled; }
     
-    /** @brief Returns currently filtered items. */
-    const std::vector<LauncherItem>& getDisplayedItems() const { return m_displayedItems; }
+    /** @brief Loads rows until @p limit are shown, or all are; returns how many are. */
+    int loadRows(int limit);
+    /** @brief @p field of the item shown at @p row; valid until the rows change. */
+    QStringView rowText(int row, ItemStore::Field field) const { return m_rows[row].text(field); }
+
+    /** @brief Pins, aliases and scorer in use; null before the first set. */
+    std::shared_ptr<const RankingContext> rankingContext() const { return m_ranking; }
 
-    /** @brief Sets the active provider set name. */
-    void setSetName(const QString& name) { m_setName = name; }
+    /** @brief Sets the pins, aliases and scorer of the active provider set. */
+    void setRankingContext(std::shared_ptr<const RankingContext> ranking)
+    {
+        m_ranking = std::move(ranking);
+        m_boosts.reset();
+        m_filterCache.clear();
+    }
+
+    /** @brief Rows exposed per fetchMore() step (and sorted per keystroke). */
+    static constexpr int PageSize = 64;
 
 signals:
     void countChanged();
+    /** @brief A new result set replaced the displayed rows (rows may have moved). */
+    void resultsChanged();
 
 private:
-    std::vector<LauncherItem> m_allItems;
-    std::vector<LauncherItem> m_displayedItems;
+    /**
+     * @brief Result set of an earlier query, kept for incremental refinement.
+     *
+     * Every entry's query extends the one below it on the stack, so the top
+     * entry's matches are a superset of the matches of any longer query.
+     */
+    struct FilterCacheEntry {
+        QString query;
+        std::shared_ptr<const FilterWorker::MatchList> matches; /**< First PageSize sorted */
+    };
+
+    /** @brief Query a result set was scored with, for working out highlights. */
+    struct Highlight {
+        std::shared_ptr<const FilterCorpus> corpus;
+        FuzzyMatcher::FoldedQuery query;
+        FuzzyMatcher::Algorithm algorithm;
+    };
+
+    /**
+     * @brief A displayed row; points into m_injected, m_corpus or m_matches.
+     *
+     * Matched rows compute their highlight positions on the first
+     * MatchPositionsRole request, so rows that are never drawn cost none.
+     */
+    struct Row {
+        const ItemStore* store;                      /**< m_injected or m_corpus->items */
+        int index;                                   /**< Record in store */
+        const FilterWorker::Match* match = nullptr;  /**< Null: nothing highlighted */
+        const Highlight* highlight = nullptr;        /**< Set with match */
+        mutable QVector<int> positions;
+        mutable bool positionsResolved = false;
+
+        QStringView text(ItemStore::Field field) const { return store->text(index, field); }
+    };
+
+    static constexpr int MaxFilterCacheDepth = 16;
+    /** Below this many items scoring is cheaper than a thread round trip */
+    static constexpr int AsyncFilterThreshold = 5000;
+
+    /** @p newResults: emit resultsChanged(), the view starts over at the top. */
+    void showAll(bool newResults = true);
+    /** @brief Rebuilds m_boosts if the history, set or a recency step changed it. */
+    void refreshBoosts();
+    FilterWorker::Job prepareJob(const QString& query);
+    void publish(const FilterWorker::Job& job, std::shared_ptr<const FilterWorker::MatchList> matches, bool remember,
+                 bool newResults = true);
+
+    /** @brief Rows that can be loaded in total (excluding injected rows). */
+    int availableRows() const;
+    /** @brief Selects the next @p count best matches into m_matchRows. */
+    void selectMatchRows(int count);
+    /** @brief Row for the @p loaded-th corpus row of the current view. */
+    Row corpusRow(int loaded) const;
+    /** @brief Rows of the current view: injected rows, then loaded corpus rows. */
+    std::vector<Row> buildRows() const;
+    /**
+     * @brief Turns the displayed rows into @p rows with row-level signals.
+     *
+     * Rows are matched by item id. The storage the old rows point into must
+     * stay alive until this returns.
+     */
+    void applyRows(std::vector<Row> rows);
+    /** @brief Positions to highlight in @p row, computed on first use. */
+    const QVector<int>& positionsAt(int row) const;
+
+    std::shared_ptr<const FilterCorpus> m_corpus;
+    QString m_query;                        /**< Last requested, reapplied by replaceItems() */
+
+    // Current view: injected rows first, then loaded corpus rows
+    ItemStore m_injected;                   /**< Alias / fallback rows */
+    std::shared_ptr<const FilterWorker::MatchList> m_matches; /**< Null: every item, in order */
+    std::shared_ptr<const Highlight> m_highlight; /**< Set with m_matches */
+    std::shared_ptr<const BoostTable> m_frecency;  /**< Row order while m_matches is null */
+    std::vector<int> m_matchRows;           /**< Slots in m_matches of loaded rows, best first */
+    std::vector<int> m_unloadedSlots;       /**< Slots not loaded yet, built on first fetchMore() */
+    size_t m_unloadedOffset = 0;            /**< Slots before this were moved to m_matchRows */
+    int m_loadedRows = 0;
+    std::vector<Row> m_rows;                /**< What the view sees */
+    bool m_applyingRows = false;            /**< No fetchMore() while diffing */
+
+    std::vector<FilterCacheEntry> m_filterCache;
+    FilterWorker m_worker;
     QString m_showMode = "drun";
-    QString m_setName = "default";
+    std::shared_ptr<const RankingContext> m_ranking; /**< Null: default set, resolved on first use */
+    std::shared_ptr<const BoostTable> m_boosts;      /**< For the next job */
     bool m_fallbackEnabled = true;
 };
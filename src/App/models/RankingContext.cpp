@@ -0,0 +1,41 @@
+#include "RankingContext.h"
+#include "FilterWorker.h"
+#include "../utils/Config.h"
+
+std::shared_ptr<const RankingContext> RankingContext::forSet(const QString& setName)
+{
+    auto context = std::make_shared<RankingContext>();
+    auto& config = Config::instance();
+
+    QStringList pins = config.getGlobalPins();
+    const QMap<QString, QString> globalAliases = config.getGlobalAliases();
+    QString scoring = config.getString("general.scoring", "greedy");
+
+    for (auto it = globalAliases.begin(); it != globalAliases.end(); ++it) {
+        context->aliases.insert(it.key(), it.value());
+    }
+
+    if (auto setOpt = config.getSet(setName)) {
+        if (!setOpt->scoring.isEmpty()) {
+            scoring = setOpt->scoring;
+        }
+        // Per-set pins take precedence (prepend)
+        pins = setOpt->pins + pins;
+
+        // Per-set aliases override global
+        for (auto it = setOpt->aliases.begin(); it != setOpt->aliases.end(); ++it) {
+            context->aliases.insert(it.key(), it.value());
+        }
+    }
+
+    // [RFC-004] Pin Boost: base 500000 + prioritization based on list order.
+    // A pin listed twice keeps its first (highest) rank.
+    for (int i = pins.size() - 1; i >= 0; --i) {
+        context->pinBoosts.insert(pins[i], 500000 + (pins.size() - i) * 1000);
+    }
+
+    context->algorithm = FuzzyMatcher::algorithmFromString(scoring);
+    context->parallelThreshold = config.getInt("general.parallel_threshold",
+                                               FilterWorker::DefaultParallelThreshold);
+    return context;
+}
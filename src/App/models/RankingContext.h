@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <memory>
+#include "../utils/FuzzyMatcher.h"
+
+/**
+ * @struct RankingContext
+ * @brief Ranking settings of one provider set, resolved once per loadSet().
+ *
+ * [RFC-004] Global and per-set pins and aliases are merged here, so the
+ * filter path never touches Config. Immutable once built; jobs share it
+ * with the filter threads.
+ */
+struct RankingContext {
+    QHash<QString, int> pinBoosts;      /**< Item id -> pin boost, earlier pins higher */
+    QHash<QString, QString> aliases;    /**< Query -> target item id or command */
+    FuzzyMatcher::Algorithm algorithm = FuzzyMatcher::Greedy;
+    int parallelThreshold = 0;          /**< See FilterWorker::Job */
+
+    /** @brief Pin boost of @p id, 0 if it is not pinned. */
+    int pinBoost(const QString& id) const { return pinBoosts.value(id, 0); }
+
+    /** @brief Resolves the context of set @p setName (or the globals only). */
+    static std::shared_ptr<const RankingContext> forSet(const QString& setName);
+};
@@ -0,0 +1,83 @@
+#include "SearchIndex.h"
+#include <algorithm>
+
+// Where each searchable field is kept in the store
+static constexpr ItemStore::Field StoreField[SearchIndex::FieldCount] = {
+    ItemStore::Primary, ItemStore::Secondary, ItemStore::Id, ItemStore::Keywords, ItemStore::Categories
+};
+
+// Maps a folded character to one of 64 bits. Lowercase letters and digits
+// get a bit each, the rest of ASCII shares the remaining bits and everything
+// beyond ASCII shares the top bit. Collisions only weaken the prefilter, a
+// character always maps to the same bit so no real match is ever rejected.
+static inline quint64 charBit(QChar c)
+{
+    const char16_t u = c.unicode();
+    if (u >= 'a' && u <= 'z') return quint64(1) << (u - 'a');
+    if (u >= '0' && u <= '9') return quint64(1) << (26 + (u - '0'));
+    if (u < 128) return quint64(1) << (36 + (u % 27));
+    return quint64(1) << 63;
+}
+
+quint64 SearchIndex::maskOf(const QChar* folded, int length)
+{
+    quint64 mask = 0;
+    for (int i = 0; i < length; ++i) {
+        mask |= charBit(folded[i]);
+    }
+    return mask;
+}
+
+void SearchIndex::build(const ItemStore& items)
+{
+    clear();
+
+    // Fold the string table once, parallel to the store's arena: a key is
+    // then just its string's range, and equal texts share it for free.
+    // The original text stays in the arena.
+    const QString& arena = items.arena();
+    m_original = arena.constData();
+    m_folded.resize(arena.size());
+    m_flags.resize(arena.size());
+    std::vector<quint64> masks(items.stringCount(), 0);
+    std::vector<bool> searched(items.stringCount(), false);
+    for (size_t i = 0; i < items.size(); ++i) {
+        for (ItemStore::Field field : StoreField) {
+            searched[items.record(static_cast<int>(i)).fields[field]] = true;
+        }
+    }
+    for (ItemStore::StringId id = 1; id < static_cast<ItemStore::StringId>(searched.size()); ++id) {
+        if (!searched[id]) continue; // Commands and icon keys are never searched
+        const QStringView text = items.string(id);
+        const quint32 offset = items.stringOffset(id);
+        FuzzyMatcher::foldText(text, m_folded.data() + offset, m_flags.data() + offset);
+        masks[id] = maskOf(m_folded.data() + offset, static_cast<int>(text.size()));
+    }
+
+    m_itemCount = static_cast<int>(items.size());
+    m_keys.reserve(items.size() * FieldCount);
+    m_fieldMasks.reserve(items.size() * FieldCount);
+    m_itemMasks.reserve(items.size());
+    for (int i = 0; i < m_itemCount; ++i) {
+        const ItemStore::Record& record = items.record(i);
+        quint64 itemMask = 0;
+        for (ItemStore::Field field : StoreField) {
+            const ItemStore::StringId id = record.fields[field];
+            m_keys.push_back({items.stringOffset(id), static_cast<quint32>(items.string(id).size())});
+            m_fieldMasks.push_back(masks[id]);
+            itemMask |= masks[id];
+        }
+        m_itemMasks.push_back(itemMask);
+    }
+}
+
+void SearchIndex::clear()
+{
+    m_itemCount = 0;
+    m_keys.clear();
+    m_original = nullptr;
+    m_folded.clear();
+    m_flags.clear();
+    m_fieldMasks.clear();
+    m_itemMasks.clear();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QChar>
+#include <vector>
+#include "ItemStore.h"
+#include "../utils/FuzzyMatcher.h"
+
+/**
+ * @class SearchIndex
+ * @brief Case-folded search keys for every searchable field of an item set.
+ *
+ * Built once per LauncherModel::setItems(). The folded text and CharFlag
+ * bits of every searched string lie parallel to the ItemStore arena, which
+ * holds the original text, so the per-keystroke filter loop never
+ * allocates or case converts. Keys with the same text (categories,
+ * "SSH Host", ...) are one interned string and share one range.
+ *
+ * Each key also carries a 64-bit character-presence mask. A query can only
+ * match a key whose mask covers the query's mask, which rejects most
+ * candidates with a single AND before any fuzzy scoring.
+ */
+class SearchIndex
+{
+public:
+    /** @brief Searchable fields, in match precedence order. */
+    enum Field {
+        Primary,
+        Secondary,
+        Id,
+        Keywords,
+        Categories,
+        FieldCount
+    };
+
+    /** @brief Rebuilds the index for @p items, which must outlive it (indices are preserved). */
+    void build(const ItemStore& items);
+    void clear();
+
+    int size() const { return m_itemCount; }
+
+    /** @brief Character-presence mask of folded text (see charBit()). */
+    static quint64 maskOf(const QChar* folded, int length);
+
+    /** @brief Union of the field masks of the item at @p index. */
+    quint64 itemMask(int index) const { return m_itemMasks[index]; }
+
+    /** @brief Mask of @p field for the item at @p index. */
+    quint64 fieldMask(int index, Field field) const
+    {
+        return m_fieldMasks[static_cast<size_t>(index) * FieldCount + field];
+    }
+
+    /** @brief Folded key of @p field for the item at @p index. */
+    FuzzyMatcher::FoldedText key(int index, Field field) const
+    {
+        const KeyRange& range = m_keys[static_cast<size_t>(index) * FieldCount + field];
+
+        FuzzyMatcher::FoldedText text;
+        text.original = m_original + range.start;
+        text.folded = m_folded.data() + range.start;
+        text.flags = m_flags.data() + range.start;
+        text.length = static_cast<int>(range.length);
+        return text;
+    }
+
+private:
+    struct KeyRange {
+        quint32 start;
+        quint32 length;
+    };
+
+    int m_itemCount = 0;
+    std::vector<KeyRange> m_keys;    /**< Arena range of each (item, field) key */
+    const QChar* m_original = nullptr; /**< The store's arena */
+    std::vector<QChar> m_folded;
+    std::vector<quint8> m_flags;
+    std::vector<quint64> m_fieldMasks;
+    std::vector<quint64> m_itemMasks;
+};
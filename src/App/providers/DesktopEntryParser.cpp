@@ -0,0 +1,275 @@
+#include "DesktopEntryParser.h"
+#include <QFile>
+#include <array>
+#include <climits>
+#include <cstring>
+#include <deque>
+
+namespace {
+    enum Key {
+        Name,
+        Comment,
+        Icon,
+        Exec,
+        Keywords,
+        Categories,
+        Actions,
+        Type,
+        OnlyShowIn,
+        TryExec,
+        Terminal,
+        Hidden,
+        NoDisplay,
+        KeyCount,
+        Unknown = -1
+    };
+
+    /** Winning raw value and its locale rank for every key of a group. */
+    struct RawGroup {
+        std::array<QByteArrayView, KeyCount> values;
+        std::array<int, KeyCount> ranks;
+        RawGroup() { ranks.fill(INT_MAX); }
+    };
+
+    bool equals(QByteArrayView view, const char* literal)
+    {
+        const size_t length = std::strlen(literal);
+        return static_cast<size_t>(view.size()) == length && std::memcmp(view.data(), literal, length) == 0;
+    }
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    QByteArrayView trimmed(QByteArrayView view)
+    {
+        qsizetype begin = 0;
+        qsizetype end = view.size();
+        while (begin < end && isSpace(view[begin])) ++begin;
+        while (end > begin && isSpace(view[end - 1])) --end;
+        return view.sliced(begin, end - begin);
+    }
+
+    Key keyOf(QByteArrayView key)
+    {
+        static const char* const Names[KeyCount] = {
+            "Name", "Comment", "Icon", "Exec", "Keywords", "Categories",
+            "Actions", "Type", "OnlyShowIn", "TryExec", "Terminal", "Hidden", "NoDisplay"
+        };
+        for (int i = 0; i < KeyCount; ++i) {
+            if (equals(key, Names[i])) return static_cast<Key>(i);
+        }
+        return Unknown;
+    }
+
+    // Appends what "\<c>" stands for to @p out
+    void appendEscaped(QByteArray& out, char c)
+    {
+        switch (c) {
+        case 's': out += ' '; break;
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case '\\': out += '\\'; break;
+        case ';': out += ';'; break;
+        default:
+            // Not an escape the spec knows; keep it verbatim
+            out += '\\';
+            out += c;
+            break;
+        }
+    }
+
+    QString decode(QByteArrayView value)
+    {
+        // Absent (and possibly empty) values are null views; memchr needs a pointer
+        if (value.isEmpty() || !std::memchr(value.data(), '\\', value.size())) {
+            return QString::fromUtf8(value);
+        }
+
+        QByteArray unescaped;
+        unescaped.reserve(value.size());
+        for (qsizetype i = 0; i < value.size(); ++i) {
+            const char c = value[i];
+            if (c == '\\' && i + 1 < value.size()) {
+                appendEscaped(unescaped, value[++i]);
+            } else {
+                unescaped += c;
+            }
+        }
+        return QString::fromUtf8(unescaped);
+    }
+
+    // Splits at unescaped ';' before unescaping, so "\;" stays inside an item
+    QStringList decodeList(QByteArrayView value)
+    {
+        QStringList list;
+        QByteArray item;
+        for (qsizetype i = 0; i < value.size(); ++i) {
+            const char c = value[i];
+            if (c == '\\' && i + 1 < value.size()) {
+                appendEscaped(item, value[++i]);
+            } else if (c == ';') {
+                if (!item.isEmpty()) list << QString::fromUtf8(item);
+                item.clear();
+            } else {
+                item += c;
+            }
+        }
+        if (!item.isEmpty()) list << QString::fromUtf8(item);
+        return list;
+    }
+
+    bool isTrue(QByteArrayView value)
+    {
+        return equals(value, "true") || equals(value, "1");
+    }
+
+    DesktopEntryParser::Group decode(const RawGroup& raw)
+    {
+        DesktopEntryParser::Group group;
+        group.name = decode(raw.values[Name]);
+        group.comment = decode(raw.values[Comment]);
+        group.icon = decode(raw.values[Icon]);
+        group.exec = decode(raw.values[Exec]);
+        group.keywords = decodeList(raw.values[Keywords]);
+        group.categories = decodeList(raw.values[Categories]);
+        group.actions = decodeList(raw.values[Actions]);
+        group.type = decode(raw.values[Type]);
+        group.onlyShowIn = decodeList(raw.values[OnlyShowIn]);
+        group.tryExec = decode(raw.values[TryExec]);
+        group.terminal = isTrue(raw.values[Terminal]);
+        group.hidden = isTrue(raw.values[Hidden]);
+        group.noDisplay = isTrue(raw.values[NoDisplay]);
+        return group;
+    }
+}
+
+DesktopEntryParser::DesktopEntryParser(const QByteArray& locale)
+{
+    // lang_COUNTRY.ENCODING@MODIFIER; the encoding never takes part in matching
+    QByteArray name = locale;
+    QByteArray modifier;
+    const qsizetype at = name.indexOf('@');
+    if (at >= 0) {
+        modifier = name.mid(at + 1);
+        name.truncate(at);
+    }
+    const qsizetype dot = name.indexOf('.');
+    if (dot >= 0) name.truncate(dot);
+    if (name.isEmpty() || name == "C" || name == "POSIX") return;
+
+    QByteArray lang = name;
+    QByteArray country;
+    const qsizetype underscore = name.indexOf('_');
+    if (underscore >= 0) {
+        lang = name.left(underscore);
+        country = name.mid(underscore + 1);
+    }
+
+    if (!country.isEmpty() && !modifier.isEmpty()) m_locales << lang + '_' + country + '@' + modifier;
+    if (!country.isEmpty()) m_locales << lang + '_' + country;
+    if (!modifier.isEmpty()) m_locales << lang + '@' + modifier;
+    m_locales << lang;
+}
+
+QByteArray DesktopEntryParser::systemLocale()
+{
+    for (const char* variable : {"LC_ALL", "LC_MESSAGES", "LANG"}) {
+        const QByteArray value = qgetenv(variable);
+        if (!value.isEmpty()) return value;
+    }
+    return QByteArray();
+}
+
+int DesktopEntryParser::localeRank(QByteArrayView locale) const
+{
+    for (int i = 0; i < m_locales.size(); ++i) {
+        const QByteArray& candidate = m_locales[i];
+        if (candidate.size() == locale.size() &&
+            std::memcmp(candidate.constData(), locale.data(), locale.size()) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool DesktopEntryParser::parseFile(const QString& path, Entry& out) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    return parse(data, out);
+}
+
+bool DesktopEntryParser::parse(QByteArrayView data, Entry& out) const
+{
+    RawGroup entry;
+    bool hasEntry = false;
+    // Deque: groups must not move while current points into them
+    std::deque<std::pair<QByteArrayView, RawGroup>> actions;
+    RawGroup* current = nullptr;
+    const int unlocalized = static_cast<int>(m_locales.size());
+
+    qsizetype pos = 0;
+    while (pos < data.size()) {
+        const char* newline = static_cast<const char*>(std::memchr(data.data() + pos, '\n', data.size() - pos));
+        const qsizetype end = newline ? newline - data.data() : data.size();
+        const QByteArrayView line = trimmed(data.sliced(pos, end - pos));
+        pos = end + 1;
+
+        if (line.isEmpty() || line[0] == '#') continue;
+
+        if (line[0] == '[') {
+            current = nullptr;
+            if (line.back() != ']') continue;
+            const QByteArrayView group = line.sliced(1, line.size() - 2);
+            if (equals(group, "Desktop Entry")) {
+                // A repeated group is invalid; the first one counts
+                if (!hasEntry) current = &entry;
+                hasEntry = true;
+            } else if (group.startsWith("Desktop Action ")) {
+                actions.emplace_back(group.sliced(15), RawGroup());
+                current = &actions.back().second;
+            }
+            continue;
+        }
+        if (!current) continue;
+
+        const char* equal = static_cast<const char*>(std::memchr(line.data(), '=', line.size()));
+        if (!equal) continue;
+        QByteArrayView key = trimmed(line.first(equal - line.data()));
+        const QByteArrayView value = trimmed(line.sliced(equal - line.data() + 1));
+
+        int rank = unlocalized;
+        if (!key.isEmpty() && key.back() == ']') {
+            const char* bracket = static_cast<const char*>(std::memchr(key.data(), '[', key.size()));
+            if (!bracket) continue;
+            const qsizetype open = bracket - key.data();
+            rank = localeRank(key.sliced(open + 1, key.size() - open - 2));
+            if (rank < 0) continue;
+            key = key.first(open);
+        }
+
+        const Key id = keyOf(key);
+        if (id == Unknown) continue;
+        // Strictly better only: the first of two equal keys wins
+        if (rank < current->ranks[id]) {
+            current->values[id] = value;
+            current->ranks[id] = rank;
+        }
+    }
+
+    if (!hasEntry) return false;
+
+    out.entry = decode(entry);
+    out.actions.clear();
+    out.actions.reserve(static_cast<qsizetype>(actions.size()));
+    for (const auto& [name, group] : actions) {
+        out.actions.append({QString::fromUtf8(name), decode(group)});
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @class DesktopEntryParser
+ * @brief Single-pass reader for the keys of .desktop files the launcher uses.
+ *
+ * Follows the Desktop Entry Specification where QSettings(IniFormat) does
+ * not: values are unescaped (\\s, \\n, \\t, \\r, \\\\, \;), commas and
+ * semicolons are plain text, lists split only at unescaped semicolons,
+ * and localized keys such as Name[de_DE] are
+ * resolved against the locale given at construction, using the spec's
+ * lang_COUNTRY\@MODIFIER > lang_COUNTRY > lang\@MODIFIER > lang fallback.
+ *
+ * The file is read into one buffer and scanned once; only the values that
+ * win are converted to QString. A parser is immutable after construction,
+ * so one instance can be shared by parsing threads.
+ */
+class DesktopEntryParser
+{
+public:
+    /** @brief Values of one group; empty if the key is absent. */
+    struct Group {
+        QString name;
+        QString comment;
+        QString icon;
+        QString exec;
+        QStringList keywords;
+        QStringList categories;
+        QStringList actions;
+        QString type;
+        QStringList onlyShowIn;
+        QString tryExec;
+        bool terminal = false;
+        bool hidden = false;    /**< Hidden: the entry counts as deleted */
+        bool noDisplay = false; /**< NoDisplay: valid, but not for menus */
+    };
+
+    struct Entry {
+        Group entry;                              /**< [Desktop Entry] */
+        QList<QPair<QString, Group>> actions;     /**< [Desktop Action <id>], in file order */
+    };
+
+    /** @param locale LC_MESSAGES style name, e.g. "de_DE.UTF-8\@euro"; empty for none. */
+    explicit DesktopEntryParser(const QByteArray& locale);
+
+    /** @brief Locale of the session: LC_ALL, LC_MESSAGES or LANG. */
+    static QByteArray systemLocale();
+
+    /** @brief Returns false if @p path cannot be read or has no [Desktop Entry]. */
+    bool parseFile(const QString& path, Entry& out) const;
+    bool parse(QByteArrayView data, Entry& out) const;
+
+private:
+    /** @brief Rank of a key's locale suffix: 0 is best, -1 is not ours. */
+    int localeRank(QByteArrayView locale) const;
+
+    QList<QByteArray> m_locales; /**< Acceptable suffixes, best first */
+};
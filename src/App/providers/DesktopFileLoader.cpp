@@ -1,119 +1,392 @@
 #include "DesktopFileLoader.h"
+#include "DesktopEntryParser.h"
 #include <QStandardPaths>
 #include <QDir>
 #include <QDirIterator>
-#include <QSettings>
-#include <QRegularExpression>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QSemaphore>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
 #include <QDebug>
+#include <algorithm>
+#include <sys/stat.h>
+
+namespace {
+    // Bump whenever the stream layout or the parsing rules change
+    constexpr quint32 CacheMagic = 0x41574543; // "AWEC"
+    constexpr quint32 CacheVersion = 5;
+    // Below this many files per thread, handing out work costs more than parsing
+    constexpr int MinFilesPerChunk = 64;
+
+    using DesktopEntry = DesktopFileLoader::Entry;
+    using DirectoryCache = DesktopFileLoader::Directory;
+
+    QDataStream& operator<<(QDataStream& out, const LauncherItem& item)
+    {
+        return out << item.id << item.primary << item.secondary << item.exec << item.iconKey
+                   << item.keywords << item.categories << item.terminal;
+    }
+
+    QDataStream& operator>>(QDataStream& in, LauncherItem& item)
+    {
+        return in >> item.id >> item.primary >> item.secondary >> item.exec >> item.iconKey
+                  >> item.keywords >> item.categories >> item.terminal;
+    }
+
+    QDataStream& operator<<(QDataStream& out, const DesktopEntry& entry)
+    {
+        out << entry.id << entry.path << entry.onlyShowIn << entry.tryExec << quint32(entry.items.size());
+        for (const auto& item : entry.items) out << item;
+        return out;
+    }
+
+    QDataStream& operator>>(QDataStream& in, DesktopEntry& entry)
+    {
+        quint32 count = 0;
+        in >> entry.id >> entry.path >> entry.onlyShowIn >> entry.tryExec >> count;
+        // Push one at a time, so a corrupt count fails the stream instead
+        // of allocating
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            in >> entry.items.emplace_back();
+        }
+        return in;
+    }
+
+    QDataStream& operator<<(QDataStream& out, const DirectoryCache& dir)
+    {
+        out << dir.path << dir.mtimes << quint32(dir.entries.size());
+        for (const auto& entry : dir.entries) out << entry;
+        return out;
+    }
+
+    QDataStream& operator>>(QDataStream& in, DirectoryCache& dir)
+    {
+        quint32 count = 0;
+        in >> dir.path >> dir.mtimes >> count;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            in >> dir.entries.emplace_back();
+        }
+        return in;
+    }
+
+    QString cachePath()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/awelauncher/items.cache";
+    }
+
+    // Nanosecond mtime, or -1 if @p path is gone
+    qint64 mtimeOf(const QString& path)
+    {
+        struct stat st;
+        if (::stat(QFile::encodeName(path).constData(), &st) != 0) return -1;
+        return static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+
+    bool isFresh(const DirectoryCache& dir)
+    {
+        for (const auto& [path, mtime] : dir.mtimes) {
+            if (mtimeOf(path) != mtime) return false;
+        }
+        return true;
+    }
+
+    std::vector<DirectoryCache> readCache(const QByteArray& locale)
+    {
+        std::vector<DirectoryCache> dirs;
+        QFile file(cachePath());
+        if (!file.open(QIODevice::ReadOnly)) return dirs;
+
+        QDataStream in(&file);
+        quint32 magic = 0, version = 0, count = 0;
+        in >> magic >> version;
+        if (magic != CacheMagic || version != CacheVersion) return dirs;
+        in.setVersion(QDataStream::Qt_6_0);
+
+        // Localized names were resolved for the locale of the writer
+        QByteArray cachedLocale;
+        in >> cachedLocale;
+        if (cachedLocale != locale) return dirs;
+
+        in >> count;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            in >> dirs.emplace_back();
+        }
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "Ignoring corrupt desktop file cache" << file.fileName();
+            dirs.clear();
+        }
+        return dirs;
+    }
+
+    void writeCache(const std::vector<DirectoryCache>& dirs, const QByteArray& locale)
+    {
+        QDir().mkpath(QFileInfo(cachePath()).path());
+        QSaveFile file(cachePath());
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Failed to write desktop file cache" << file.fileName();
+            return;
+        }
+
+        QDataStream out(&file);
+        out << CacheMagic << CacheVersion;
+        out.setVersion(QDataStream::Qt_6_0);
+        out << locale;
+        out << quint32(dirs.size());
+        for (const auto& dir : dirs) out << dir;
+        file.commit();
+    }
+
+    // Same as removing " %[%a-zA-Z]" (XDG field codes), without a regex
+    QString stripFieldCodes(const QString& exec)
+    {
+        QString result;
+        result.reserve(exec.size());
+        for (qsizetype i = 0; i < exec.size(); ++i) {
+            if (exec[i] == ' ' && i + 2 < exec.size() && exec[i + 1] == '%') {
+                const char16_t code = exec[i + 2].unicode();
+                if (code == '%' || (code >= 'a' && code <= 'z') || (code >= 'A' && code <= 'Z')) {
+                    i += 2;
+                    continue;
+                }
+            }
+            result += exec[i];
+        }
+        return result;
+    }
+
+    DesktopEntry toEntry(const QString& id, const QString& path, const DesktopEntryParser::Entry& parsed)
+    {
+        DesktopEntry entry;
+        entry.id = id;
+        entry.path = path;
+
+        const auto& main = parsed.entry;
+        // Desktop names contain no ';', so the list keeps its file form
+        entry.onlyShowIn = main.onlyShowIn.join(';');
+        entry.tryExec = main.tryExec;
+
+        // Still returned without items: a Hidden entry also hides the one
+        // it overrides in a lower-precedence directory
+        if (main.type != "Application" || main.name.isEmpty() || main.exec.isEmpty() ||
+            main.hidden || main.noDisplay) {
+            return entry;
+        }
+        
+        const QString exec = stripFieldCodes(main.exec);
+        const QString icon = main.icon.isEmpty() ? "application-x-executable" : main.icon;
+        const QString keywords = main.keywords.join(' ');
+        const QString categories = main.categories.join(' ');
+
+        entry.items.push_back({
+            id,
+            main.name,
+            main.comment.isEmpty() ? exec : main.comment,
+            exec,
+            icon,
+            keywords,
+            categories,
+            false,
+            main.terminal
+        });
+
+        // Actions listed in the entry, in that order
+        for (const QString& action : main.actions) {
+            auto it = std::find_if(parsed.actions.begin(), parsed.actions.end(), [&action](const auto& group) {
+                return group.first == action;
+            });
+            if (it == parsed.actions.end()) continue;
+            const auto& group = it->second;
+            
+            if (!group.name.isEmpty() && !group.exec.isEmpty()) {
+                entry.items.push_back({
+                    id + ":" + action,
+                    main.name + ": " + group.name,
+                    "Action",
+                    stripFieldCodes(group.exec),
+                    group.icon.isEmpty() ? icon : group.icon,
+                    keywords, // Inherit keywords? Maybe.
+                    categories, // Inherit categories
+                    false,
+                    main.terminal // Inherit terminal setting? Usually actions specify. Assuming same for now.
+                });
+            }
+        }
+        return entry;
+    }
+
+    /** @brief Lists a directory for parsing; entries get one slot per file. */
+    DirectoryCache listDirectory(const QString& path, QStringList& files)
+    {
+        DirectoryCache dir;
+        dir.path = path;
+
+        // Take mtimes before listing, so a change during the scan is caught
+        // by the next one rather than lost
+        dir.mtimes.append({path, mtimeOf(path)});
+        QDirIterator subdirs(path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (subdirs.hasNext()) {
+            const QString subdir = subdirs.next();
+            dir.mtimes.append({subdir, mtimeOf(subdir)});
+        }
+
+        QDirIterator it(path, QStringList() << "*.desktop", QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            files << it.next();
+            DesktopEntry& entry = dir.entries.emplace_back();
+            entry.id = it.fileName();
+            entry.path = files.back();
+        }
+        return dir;
+    }
+
+    // Threads for parsing, separate from the icon loaders' global pool
+    QThreadPool& parsingPool()
+    {
+        static QThreadPool pool;
+        return pool;
+    }
+
+    /** @brief Parses @p files into @p entries (same order), spread over the pool. */
+    void parseFiles(const QStringList& files, const std::vector<DesktopEntry*>& entries,
+                    const DesktopEntryParser& parser)
+    {
+        const int count = static_cast<int>(files.size());
+        auto parseRange = [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                DesktopEntryParser::Entry parsed;
+                if (parser.parseFile(files[i], parsed)) {
+                    *entries[i] = toEntry(entries[i]->id, files[i], parsed);
+                }
+            }
+        };
+
+        const int chunks = std::clamp(count / MinFilesPerChunk, 1, QThread::idealThreadCount());
+        if (chunks == 1) {
+            parseRange(0, count);
+            return;
+        }
+        QSemaphore done;
+        for (int chunk = 1; chunk < chunks; ++chunk) {
+            parsingPool().start([&parseRange, &done, count, chunks, chunk]() {
+                parseRange(count * chunk / chunks, count * (chunk + 1) / chunks);
+                done.release();
+            });
+        }
+        parseRange(0, count / chunks);
+        done.acquire(chunks - 1);
+    }
+
+    // Session-dependent checks, applied to cached and fresh entries alike
+    bool isShown(const DesktopEntry& entry, const QString& currentDesktop)
+    {
+        if (entry.items.empty()) return false;
+
+        if (!entry.onlyShowIn.isEmpty() && !currentDesktop.isEmpty()) {
+            QStringList onlyShowList = entry.onlyShowIn.split(';', Qt::SkipEmptyParts);
+            if (!onlyShowList.contains(currentDesktop, Qt::CaseInsensitive)) {
+                return false;
+            }
+        }
+
+        // XDG: TryExec - if binary missing, ignore app
+        if (!entry.tryExec.isEmpty()) {
+            // If absolute path, check existence
+            if (entry.tryExec.startsWith("/")) {
+                return QFile::exists(entry.tryExec);
+            }
+            // Check path
+            return !QStandardPaths::findExecutable(entry.tryExec).isEmpty();
+        }
+        return true;
+    }
+}
 
 std::vector<LauncherItem> DesktopFileLoader::scan()
 {
-    std::vector<LauncherItem> items;
+    return merge(load());
+}
+
+QStringList DesktopFileLoader::applicationDirs()
+{
     QStringList dirs = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
     
     // Add some common fallbacks if standard paths are empty (unlikely on Linux)
     if (dirs.isEmpty()) {
         dirs << "/usr/share/applications" << QDir::homePath() + "/.local/share/applications";
     }
-    
-    qDebug() << "Scanning for desktop files in:" << dirs;
+    return dirs;
+}
 
-    // Keep track of IDs to avoid duplicates (e.g. user override)
-    QHash<QString, bool> seenIds;
+std::vector<DesktopFileLoader::Directory> DesktopFileLoader::load()
+{
+    const QStringList dirs = applicationDirs();
+    qDebug() << "Scanning for desktop files in:" << dirs;
 
+    const QByteArray locale = DesktopEntryParser::systemLocale();
+    std::vector<DirectoryCache> cached = readCache(locale);
+    std::vector<DirectoryCache> current;
+    current.reserve(dirs.size());
+    QStringList files;
+    std::vector<size_t> stale;
+    bool changed = cached.size() != static_cast<size_t>(dirs.size());
     for (const auto &path : dirs) {
-        QDirIterator it(path, QStringList() << "*.desktop", QDir::Files, QDirIterator::Subdirectories);
-        while (it.hasNext()) {
-            QString filePath = it.next();
-            QString id = it.fileInfo().fileName();
+        auto hit = std::find_if(cached.begin(), cached.end(), [&path](const DirectoryCache& dir) {
+            return dir.path == path;
+        });
+        if (hit != cached.end() && isFresh(*hit)) {
+            current.push_back(std::move(*hit));
+        } else {
+            qDebug() << "Parsing desktop files in" << path;
+            stale.push_back(current.size());
+            current.push_back(listDirectory(path, files));
+            changed = true;
+        }
+    }
 
-            if (seenIds.contains(id)) continue;
-            seenIds.insert(id, true);
+    if (changed) {
+        // Files of all stale directories are parsed as one batch; results
+        // land in their directory's slots, so XDG precedence is kept
+        std::vector<DesktopEntry*> targets;
+        targets.reserve(files.size());
+        for (size_t index : stale) {
+            for (auto& entry : current[index].entries) targets.push_back(&entry);
+        }
+        parseFiles(files, targets, DesktopEntryParser(locale));
+        writeCache(current, locale);
+    }
+    return current;
+}
 
-            QSettings desktopFile(filePath, QSettings::IniFormat);
-            
-            desktopFile.beginGroup("Desktop Entry");
-            
-            QString currentDesktop = qgetenv("XDG_CURRENT_DESKTOP");
-            QString onlyShowInStr = desktopFile.value("OnlyShowIn").toString();
-            if (!onlyShowInStr.isEmpty() && !currentDesktop.isEmpty()) {
-                QStringList onlyShowList = onlyShowInStr.split(';', Qt::SkipEmptyParts);
-                if (!onlyShowList.contains(currentDesktop, Qt::CaseInsensitive)) {
-                    continue;
-                }
-            }
+DesktopFileLoader::Entry DesktopFileLoader::parseFile(const QString& path)
+{
+    const QString id = QFileInfo(path).fileName();
+    DesktopEntryParser::Entry parsed;
+    if (!DesktopEntryParser(DesktopEntryParser::systemLocale()).parseFile(path, parsed)) {
+        Entry entry;
+        entry.id = id;
+        entry.path = path;
+        return entry;
+    }
+    return toEntry(id, path, parsed);
+}
 
-            // XDG: TryExec - if binary missing, ignore app
-            QString tryExec = desktopFile.value("TryExec").toString();
-            if (!tryExec.isEmpty()) {
-                // If absolute path, check existence
-                if (tryExec.startsWith("/")) {
-                   if (!QFile::exists(tryExec)) continue;
-                } else {
-                    // Check path
-                    if (QStandardPaths::findExecutable(tryExec).isEmpty()) continue;
-                }
-            }
-            
-            QString name = desktopFile.value("Name").toString();
-            QString exec = desktopFile.value("Exec").toString();
-            QString icon = desktopFile.value("Icon").toString();
-            QString comment = desktopFile.value("Comment").toString();
-            QString keywords = desktopFile.value("Keywords").toString().replace(';', ' ');
-            QString categories = desktopFile.value("Categories").toString().replace(';', ' ');
-            QString actionsStr = desktopFile.value("Actions").toString();
-            QString type = desktopFile.value("Type").toString();
-            bool terminal = desktopFile.value("Terminal", false).toBool();
-
-            if (type != "Application" || name.isEmpty() || exec.isEmpty()) {
-                continue;
-            }
-            
-            // Clean up Exec (XDG codes)
-            exec.remove(QRegularExpression(" %[%a-zA-Z]"));
-
-            items.push_back({
-                id,
-                name,
-                comment.isEmpty() ? exec : comment,
-                exec,
-                icon.isEmpty() ? "application-x-executable" : icon,
-                keywords,
-                categories,
-                false,
-                terminal
-            });
-            
-            desktopFile.endGroup(); // End "Desktop Entry"
-
-            // Parse Actions
-            if (!actionsStr.isEmpty()) {
-                QStringList actions = actionsStr.split(';', Qt::SkipEmptyParts);
-                for (const QString& action : actions) {
-                    desktopFile.beginGroup("Desktop Action " + action);
-                    
-                    QString actName = desktopFile.value("Name").toString();
-                    QString actExec = desktopFile.value("Exec").toString();
-                    QString actIcon = desktopFile.value("Icon").toString(); // Optional override check?
-                    
-                    if (!actName.isEmpty() && !actExec.isEmpty()) {
-                        actExec.remove(QRegularExpression(" %[%a-zA-Z]"));
-                        
-                        items.push_back({
-                            id + ":" + action,
-                            name + ": " + actName,
-                            "Action",
-                            actExec,
-                            actIcon.isEmpty() ? (icon.isEmpty() ? "application-x-executable" : icon) : actIcon,
-                            keywords, // Inherit keywords? Maybe.
-                            categories, // Inherit categories
-                            false,
-                            terminal // Inherit terminal setting? Usually actions specify. Assuming same for now.
-                        });
-                    }
-                    desktopFile.endGroup();
-                }
-            }
+std::vector<LauncherItem> DesktopFileLoader::merge(const std::vector<Directory>& dirs)
+{
+    std::vector<LauncherItem> items;
+
+    // Keep track of IDs to avoid duplicates (e.g. user override)
+    QSet<QString> seenIds;
+    const QString currentDesktop = qgetenv("XDG_CURRENT_DESKTOP");
+
+    for (const auto& dir : dirs) {
+        for (const auto& entry : dir.entries) {
+            if (seenIds.contains(entry.id)) continue;
+            seenIds.insert(entry.id);
+
+            if (!isShown(entry, currentDesktop)) continue;
+            items.insert(items.end(), entry.items.begin(), entry.items.end());
         }
     }
     
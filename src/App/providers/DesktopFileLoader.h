@@ -1,10 +1,53 @@
 #pragma once
 
+#include <QPair>
+#include <QStringList>
+#include <QVector>
 #include <vector>
 #include "../models/LauncherModel.h"
 
+/**
+ * @class DesktopFileLoader
+ * @brief Loads applications from the .desktop files in the XDG directories.
+ *
+ * Parsed entries are cached per applications directory in
+ * items.cache under the cache directory. A directory is re-parsed only
+ * when the mtime of it or one of its subdirectories changed, which
+ * happens whenever a .desktop file is added, removed or replaced.
+ * OnlyShowIn and TryExec are checked on every scan, since they depend
+ * on the session rather than on the files.
+ *
+ * Files of stale directories are read with DesktopEntryParser on a
+ * thread pool; results keep their directory's slot, so ids still
+ * resolve in XDG precedence order.
+ */
 class DesktopFileLoader
 {
 public:
+    /** @brief One .desktop file, with the session-dependent checks still pending. */
+    struct Entry {
+        QString id;
+        QString path;                    /**< Absolute path of the file */
+        QString onlyShowIn;
+        QString tryExec;
+        std::vector<LauncherItem> items; /**< Empty if the file is not a launchable application */
+    };
+
+    /** @brief Parsed content of one applications directory. */
+    struct Directory {
+        QString path;
+        QVector<QPair<QString, qint64>> mtimes; /**< The directory and its subdirectories */
+        std::vector<Entry> entries;
+    };
+
     static std::vector<LauncherItem> scan();
+
+    /** @brief XDG applications directories, highest precedence first. */
+    static QStringList applicationDirs();
+    /** @brief Entries of every applications directory, from the cache where fresh. */
+    static std::vector<Directory> load();
+    /** @brief Parses a single file, e.g. one reported changed by inotify. */
+    static Entry parseFile(const QString& path);
+    /** @brief Visible items of @p dirs, shadowed in order and sorted by name. */
+    static std::vector<LauncherItem> merge(const std::vector<Directory>& dirs);
 };
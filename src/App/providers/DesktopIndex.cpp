@@ -0,0 +1,216 @@
+#include "DesktopIndex.h"
+#include <QDebug>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Folds the burst of events of a package install into one update
+    constexpr int DebounceMs = 250;
+}
+
+DesktopIndex::DesktopIndex(QObject *parent)
+    : QObject(parent)
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DebounceMs);
+    connect(&m_debounce, &QTimer::timeout, this, &DesktopIndex::applyPending);
+    connect(&m_watcher, &DirectoryWatcher::entryChanged, this, &DesktopIndex::onEntryChanged);
+    // A directory recreated at the same path is watched again from its parent
+    connect(&m_watcher, &DirectoryWatcher::watchRemoved, this, [this](const QString& dir) {
+        m_watched.remove(dir);
+    });
+    connect(&m_watcher, &DirectoryWatcher::overflowed, this, [this]() {
+        m_reloadPending = true;
+        m_debounce.start();
+    });
+}
+
+bool DesktopIndex::start()
+{
+    m_dirs = DesktopFileLoader::load();
+    m_items = DesktopFileLoader::merge(m_dirs);
+    ++m_version;
+
+    if (!m_watcher.isValid()) {
+        qWarning() << "DesktopIndex: applications will not update live";
+        return false;
+    }
+    for (int i = 0; i < static_cast<int>(m_dirs.size()); ++i) {
+        watchRoot(i);
+    }
+    qDebug() << "DesktopIndex: watching" << m_watcher.count() << "directories";
+    return true;
+}
+
+bool DesktopIndex::watchRoot(int dir)
+{
+    const QString& path = m_dirs[dir].path;
+    if (m_watcher.addPath(path)) {
+        m_unwatched.remove(dir);
+        watchTree(dir, path);
+        const QString ancestor = m_ancestors.take(dir);
+        if (!ancestor.isEmpty()) releaseAncestor(ancestor);
+        return true;
+    }
+
+    // Missing: watch the deepest existing ancestor, which reports the
+    // next level being created
+    m_unwatched.insert(dir);
+    QString ancestor = path;
+    while (ancestor.size() > 1) {
+        ancestor = QFileInfo(ancestor).path();
+        if (m_watcher.addPath(ancestor)) break;
+    }
+    // Levels created or removed since move the watch down or up
+    const QString previous = std::exchange(m_ancestors[dir], ancestor);
+    if (!previous.isEmpty() && previous != ancestor) releaseAncestor(previous);
+    return false;
+}
+
+void DesktopIndex::releaseAncestor(const QString& ancestor)
+{
+    // Often $HOME or ~/.local: every change there would wake the daemon.
+    // The watch is shared with other missing directories below it, and
+    // with the ancestor itself if it is inside an applications directory.
+    for (const QString& other : std::as_const(m_ancestors)) {
+        if (other == ancestor) return;
+    }
+    if (m_watched.contains(ancestor)) return;
+    m_watcher.removePath(ancestor);
+}
+
+void DesktopIndex::watchTree(int dir, const QString& path)
+{
+    QStringList paths{path};
+    QDirIterator subdirs(path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (subdirs.hasNext()) {
+        paths << subdirs.next();
+    }
+
+    for (const QString& watched : paths) {
+        if (m_watcher.addPath(watched)) {
+            m_watched.insert(watched, dir);
+        }
+    }
+}
+
+void DesktopIndex::onEntryChanged(const QString& dir, const QString& name, bool isDir)
+{
+    if (isDir && !name.isEmpty()) {
+        const QString created = dir + '/' + name;
+        for (int unwatched : std::as_const(m_unwatched)) {
+            const QString& path = m_dirs[unwatched].path;
+            if (path == created || path.startsWith(created + '/')) {
+                m_retryUnwatched = true;
+                m_debounce.start();
+                break;
+            }
+        }
+    }
+
+    const int index = m_watched.value(dir, -1);
+    if (index < 0) return;
+
+    if (name.isEmpty()) {
+        m_pending.insert(dir, index);
+    } else if (isDir || name.endsWith(".desktop")) {
+        m_pending.insert(dir + '/' + name, index);
+    } else {
+        return;
+    }
+    m_debounce.start();
+}
+
+void DesktopIndex::applyPending()
+{
+    if (m_reloadPending) {
+        reload();
+        return;
+    }
+
+    bool changed = false;
+    QHash<QString, int> pending = std::exchange(m_pending, {});
+    if (std::exchange(m_retryUnwatched, false)) {
+        for (int dir : QSet<int>(m_unwatched)) {
+            // Loaded like a new subdirectory
+            if (watchRoot(dir)) pending.insert(m_dirs[dir].path, dir);
+        }
+    }
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) {
+        changed |= update(it.value(), it.key());
+    }
+    if (!changed) return;
+
+    m_items = DesktopFileLoader::merge(m_dirs);
+    ++m_version;
+    qDebug() << "DesktopIndex: applied" << pending.size() << "changes";
+    emit itemsChanged();
+}
+
+void DesktopIndex::reload()
+{
+    qDebug() << "DesktopIndex: events were lost, reloading";
+    m_watcher.clear();
+    m_watched.clear();
+    m_pending.clear();
+    m_unwatched.clear();
+    m_ancestors.clear();
+    m_retryUnwatched = false;
+    m_reloadPending = false;
+
+    m_dirs = DesktopFileLoader::load();
+    for (int i = 0; i < static_cast<int>(m_dirs.size()); ++i) {
+        watchRoot(i);
+    }
+    m_items = DesktopFileLoader::merge(m_dirs);
+    ++m_version;
+    emit itemsChanged();
+}
+
+bool DesktopIndex::update(int dir, const QString& path)
+{
+    auto& entries = m_dirs[dir].entries;
+    auto upsert = [&entries](const QString& file) {
+        DesktopFileLoader::Entry entry = DesktopFileLoader::parseFile(file);
+        auto it = std::find_if(entries.begin(), entries.end(), [&file](const auto& existing) {
+            return existing.path == file;
+        });
+        if (it != entries.end()) {
+            *it = std::move(entry);
+        } else {
+            entries.push_back(std::move(entry));
+        }
+    };
+
+    const QFileInfo info(path);
+    if (info.isDir()) {
+        // A new directory: watch it and take the files already inside
+        watchTree(dir, path);
+        bool changed = false;
+        QDirIterator it(path, QStringList() << "*.desktop", QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            upsert(it.next());
+            changed = true;
+        }
+        return changed;
+    }
+    if (info.exists()) {
+        upsert(path);
+        return true;
+    }
+
+    // Gone: a file, or a directory with everything below it
+    const QString prefix = path + '/';
+    auto removed = std::remove_if(entries.begin(), entries.end(), [&](const auto& entry) {
+        return entry.path == path || entry.path.startsWith(prefix);
+    });
+    const bool changed = removed != entries.end();
+    entries.erase(removed, entries.end());
+    if (path == m_dirs[dir].path) {
+        // The applications directory itself: wait for it to come back
+        watchRoot(dir);
+    }
+    return changed;
+}
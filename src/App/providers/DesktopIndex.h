@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <vector>
+#include "DesktopFileLoader.h"
+#include "../utils/DirectoryWatcher.h"
+
+/**
+ * @class DesktopIndex
+ * @brief Resident application list for daemon mode, kept current with inotify.
+ *
+ * Loads every applications directory once (through the DesktopFileLoader
+ * cache) and watches the directories and their subdirectories. Events are
+ * collected per path and applied after a short debounce: a changed or new
+ * .desktop file is parsed again, a removed file or directory drops its
+ * entries, and a new directory is watched and its files added. Showing
+ * the launcher then costs nothing that depends on the number of files.
+ *
+ * An applications directory that does not exist, or is deleted, is
+ * waited for through its nearest existing ancestor and loaded once it is
+ * created.
+ */
+class DesktopIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DesktopIndex(QObject *parent = nullptr);
+
+    /**
+     * @brief Loads the directories and starts watching them.
+     * @return false if inotify is unavailable; items() is loaded regardless.
+     */
+    bool start();
+
+    /** @brief Visible items, as DesktopFileLoader::scan() would return them. */
+    const std::vector<LauncherItem>& items() const { return m_items; }
+    /** @brief Incremented whenever items() changes. */
+    quint64 version() const { return m_version; }
+
+signals:
+    void itemsChanged();
+
+private slots:
+    void onEntryChanged(const QString& dir, const QString& name, bool isDir);
+    void applyPending();
+
+private:
+    void reload();
+    /** @brief Watches applications directory @p dir, or an ancestor until it exists. */
+    bool watchRoot(int dir);
+    /** @brief Stops watching @p ancestor unless something else needs it. */
+    void releaseAncestor(const QString& ancestor);
+    void watchTree(int dir, const QString& path);
+    /** @brief Brings the entries under @p path up to date; returns true if any changed. */
+    bool update(int dir, const QString& path);
+
+    DirectoryWatcher m_watcher;
+    QTimer m_debounce;
+    std::vector<DesktopFileLoader::Directory> m_dirs;
+    QHash<QString, int> m_watched;  /**< Watched path -> applications directory index */
+    QHash<QString, int> m_pending;  /**< Changed path -> applications directory index */
+    QSet<int> m_unwatched;          /**< Applications directories waiting to be created */
+    QHash<int, QString> m_ancestors; /**< Unwatched directory -> ancestor watched for it */
+    bool m_retryUnwatched = false;  /**< An ancestor of one of them changed */
+    bool m_reloadPending = false;   /**< Events were lost */
+    std::vector<LauncherItem> m_items;
+    quint64 m_version = 0;
+};
@@ -0,0 +1,140 @@
+#include "PathIndex.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <utility>
+
+namespace {
+    // Folds the burst of events of a package install into one update
+    constexpr int DebounceMs = 250;
+}
+
+PathIndex::PathIndex(QObject *parent)
+    : QObject(parent)
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DebounceMs);
+    connect(&m_debounce, &QTimer::timeout, this, &PathIndex::applyPending);
+    connect(&m_watcher, &DirectoryWatcher::entryChanged, this,
+            [this](const QString& dir, const QString& name, bool isDir) {
+        if (isPathDirectory(dir)) {
+            m_pending.insert(dir);
+            m_debounce.start();
+        }
+        // Ancestors are only watched for the directories below them
+        if (!isDir || name.isEmpty()) return;
+        const QString created = dir + '/' + name;
+        for (const QString& path : std::as_const(m_unwatched)) {
+            if (path == created || path.startsWith(created + '/')) {
+                m_retryUnwatched = true;
+                m_debounce.start();
+                return;
+            }
+        }
+    });
+    connect(&m_watcher, &DirectoryWatcher::overflowed, this, [this]() {
+        m_reloadPending = true;
+        m_debounce.start();
+    });
+}
+
+bool PathIndex::start()
+{
+    m_dirs = PathProvider::load();
+    m_items = PathProvider::merge(m_dirs);
+    ++m_version;
+
+    if (!m_watcher.isValid()) {
+        qWarning() << "PathIndex: PATH executables will not update live";
+        return false;
+    }
+    watchAll();
+    qDebug() << "PathIndex: watching" << m_watcher.count() << "directories";
+    return true;
+}
+
+void PathIndex::watchAll()
+{
+    m_unwatched.clear();
+    m_ancestors.clear();
+    m_retryUnwatched = false;
+    for (const auto& dir : m_dirs) {
+        watchDirectory(dir.path);
+    }
+}
+
+bool PathIndex::watchDirectory(const QString& path)
+{
+    if (m_watcher.addPath(path)) {
+        m_unwatched.remove(path);
+        const QString ancestor = m_ancestors.take(path);
+        if (!ancestor.isEmpty()) releaseAncestor(ancestor);
+        return true;
+    }
+
+    // Missing: watch the deepest existing ancestor, which reports the
+    // next level being created (mkdir -p creates one level at a time)
+    m_unwatched.insert(path);
+    QString ancestor = path;
+    while (ancestor.size() > 1) {
+        ancestor = QFileInfo(ancestor).path();
+        if (m_watcher.addPath(ancestor)) break;
+    }
+    // Levels created or removed since move the watch down or up
+    const QString previous = std::exchange(m_ancestors[path], ancestor);
+    if (!previous.isEmpty() && previous != ancestor) releaseAncestor(previous);
+    return false;
+}
+
+void PathIndex::releaseAncestor(const QString& ancestor)
+{
+    // Often $HOME or ~/.local: every change there would wake the daemon.
+    // The watch is shared with other missing directories below it, and
+    // with the ancestor itself if it is a watched PATH directory.
+    for (const QString& other : std::as_const(m_ancestors)) {
+        if (other == ancestor) return;
+    }
+    if (isPathDirectory(ancestor) && !m_unwatched.contains(ancestor)) return;
+    m_watcher.removePath(ancestor);
+}
+
+bool PathIndex::isPathDirectory(const QString& path) const
+{
+    for (const auto& dir : m_dirs) {
+        if (dir.path == path) return true;
+    }
+    return false;
+}
+
+void PathIndex::applyPending()
+{
+    if (m_reloadPending) {
+        m_reloadPending = false;
+        m_pending.clear();
+        m_watcher.clear();
+        m_dirs = PathProvider::load();
+        watchAll();
+    } else {
+        QSet<QString> pending = std::exchange(m_pending, {});
+        // A directory that was deleted needs a new watch, on itself if it
+        // was recreated meanwhile or on an ancestor until it is
+        for (const QString& path : std::as_const(pending)) {
+            watchDirectory(path);
+        }
+        if (std::exchange(m_retryUnwatched, false)) {
+            for (const QString& path : QSet<QString>(m_unwatched)) {
+                if (watchDirectory(path)) pending.insert(path);
+            }
+        }
+        // Listed after the watch is in place, so nothing created in
+        // between is missed
+        for (auto& dir : m_dirs) {
+            if (pending.contains(dir.path)) {
+                dir = PathProvider::listDirectory(dir.path);
+            }
+        }
+    }
+
+    m_items = PathProvider::merge(m_dirs);
+    ++m_version;
+    emit itemsChanged();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <vector>
+#include "PathProvider.h"
+#include "../utils/DirectoryWatcher.h"
+
+/**
+ * @class PathIndex
+ * @brief Resident PATH executable list for daemon mode, kept current with inotify.
+ *
+ * Watches every PATH directory. A directory that reports a change is
+ * listed again after a short debounce; the others keep their listing.
+ * Permission changes (chmod +x) are reported too, which the mtime check
+ * of PathProvider's cache cannot see. A PATH directory that is missing,
+ * or is deleted, is waited for through its nearest existing ancestor and
+ * watched again once it is created.
+ */
+class PathIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PathIndex(QObject *parent = nullptr);
+
+    /**
+     * @brief Loads the PATH directories and starts watching them.
+     * @return false if inotify is unavailable; items() is loaded regardless.
+     */
+    bool start();
+
+    /** @brief Items as PathProvider::scan() would return them. */
+    const std::vector<LauncherItem>& items() const { return m_items; }
+    /** @brief Incremented whenever items() changes. */
+    quint64 version() const { return m_version; }
+
+signals:
+    void itemsChanged();
+
+private slots:
+    void applyPending();
+
+private:
+    void watchAll();
+    /** @brief Watches @p path, or its nearest existing ancestor until it exists. */
+    bool watchDirectory(const QString& path);
+    /** @brief Stops watching @p ancestor unless something else needs it. */
+    void releaseAncestor(const QString& ancestor);
+    bool isPathDirectory(const QString& path) const;
+
+    DirectoryWatcher m_watcher;
+    QTimer m_debounce;
+    std::vector<PathProvider::Directory> m_dirs;
+    QSet<QString> m_pending;        /**< PATH directories to list again */
+    QSet<QString> m_unwatched;      /**< PATH directories waiting to be created */
+    QHash<QString, QString> m_ancestors; /**< Unwatched directory -> ancestor watched for it */
+    bool m_retryUnwatched = false;  /**< An ancestor of one of them changed */
+    bool m_reloadPending = false;   /**< Events were lost */
+    std::vector<LauncherItem> m_items;
+    quint64 m_version = 0;
+};
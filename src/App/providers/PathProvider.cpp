@@ -1,29 +1,174 @@
 #include "PathProvider.h"
 #include <QDir>
 #include <QStringList>
-#include <QFileInfoList>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
 #include <QDebug>
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // Bump whenever the stream layout or the listing rules change
+    constexpr quint32 CacheMagic = 0x41574550; // "AWEP"
+    constexpr quint32 CacheVersion = 2;
+
+    QString cachePath() {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/awelauncher/path.cache";
+    }
+
+    // Nanosecond mtime, or -1 if @p path is gone
+    qint64 mtimeOf(const QString& path) {
+        struct stat st;
+        if (::stat(QFile::encodeName(path).constData(), &st) != 0) return -1;
+        return static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+
+    QDataStream& operator<<(QDataStream& out, const PathProvider::Directory& dir) {
+        return out << dir.path << dir.mtime << dir.executables;
+    }
+
+    QDataStream& operator>>(QDataStream& in, PathProvider::Directory& dir) {
+        return in >> dir.path >> dir.mtime >> dir.executables;
+    }
+
+    std::vector<PathProvider::Directory> readCache() {
+        std::vector<PathProvider::Directory> dirs;
+        QFile file(cachePath());
+        if (!file.open(QIODevice::ReadOnly)) return dirs;
+
+        QDataStream in(&file);
+        quint32 magic = 0, version = 0, count = 0;
+        in >> magic >> version;
+        if (magic != CacheMagic || version != CacheVersion) return dirs;
+        in.setVersion(QDataStream::Qt_6_0);
+
+        in >> count;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            in >> dirs.emplace_back();
+        }
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "Ignoring corrupt PATH cache" << file.fileName();
+            dirs.clear();
+        }
+        return dirs;
+    }
+
+    void writeCache(const std::vector<PathProvider::Directory>& dirs) {
+        QDir().mkpath(QFileInfo(cachePath()).path());
+        QSaveFile file(cachePath());
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Failed to write PATH cache" << file.fileName();
+            return;
+        }
+
+        QDataStream out(&file);
+        out << CacheMagic << CacheVersion;
+        out.setVersion(QDataStream::Qt_6_0);
+        out << quint32(dirs.size());
+        for (const auto& dir : dirs) out << dir;
+        file.commit();
+    }
+}
 
 std::vector<LauncherItem> PathProvider::scan() {
+    return merge(load());
+}
+
+QStringList PathProvider::pathDirs() {
+    // Absolute and clean, so /usr/bin/ and /usr/bin are one directory and
+    // relative entries (., bin) are shown and watched as real paths
+    QStringList dirs;
+    for (const QString& path : QString(qgetenv("PATH")).split(":", Qt::SkipEmptyParts)) {
+        dirs << QDir::cleanPath(QDir(path).absolutePath());
+    }
+    dirs.removeDuplicates();
+    return dirs;
+}
+
+std::vector<PathProvider::Directory> PathProvider::load() {
+    const QStringList paths = pathDirs();
+    std::vector<Directory> cached = readCache();
+    std::vector<Directory> dirs;
+    dirs.reserve(paths.size());
+
+    bool changed = cached.size() != static_cast<size_t>(paths.size());
+    for (const QString& path : paths) {
+        auto hit = std::find_if(cached.begin(), cached.end(), [&path](const Directory& dir) {
+            return dir.path == path;
+        });
+        if (hit != cached.end() && hit->mtime == mtimeOf(path)) {
+            dirs.push_back(std::move(*hit));
+        } else {
+            dirs.push_back(listDirectory(path));
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        writeCache(dirs);
+    }
+    return dirs;
+}
+
+PathProvider::Directory PathProvider::listDirectory(const QString& path) {
+    Directory dir;
+    dir.path = path;
+    // Taken before listing, so a change during the listing is caught next time
+    dir.mtime = mtimeOf(path);
+
+    DIR* handle = ::opendir(QFile::encodeName(path).constData());
+    if (!handle) return dir;
+    const int fd = ::dirfd(handle);
+
+    while (const dirent* entry = ::readdir(handle)) {
+        const char* name = entry->d_name;
+        // Hidden files stay hidden, as with QDir (this also skips . and ..)
+        if (name[0] == '.') continue;
+
+        // d_type answers "regular file?" for free; symlinks (all of a Nix
+        // profile) and filesystems without d_type need a stat of the target
+        bool regular = entry->d_type == DT_REG;
+        if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            regular = ::fstatat(fd, name, &st, 0) == 0 && S_ISREG(st.st_mode);
+        }
+        if (regular && ::faccessat(fd, name, X_OK, 0) == 0) {
+            dir.executables << QFile::decodeName(name);
+        }
+    }
+    ::closedir(handle);
+
+    dir.executables.sort();
+    return dir;
+}
+
+std::vector<LauncherItem> PathProvider::merge(const std::vector<Directory>& dirs) {
     std::vector<LauncherItem> items;
-    QStringList pathDirs = QString(qgetenv("PATH")).split(":", Qt::SkipEmptyParts);
+    QSet<QString> seen;
     
-    for (const QString& dir : pathDirs) {
-        QDir d(dir);
-        if (!d.exists()) continue;
-        
-        QFileInfoList files = d.entryInfoList(QDir::Files | QDir::Executable, QDir::Name);
-        for (const QFileInfo& file : files) {
+    for (const Directory& dir : dirs) {
+        // Only / itself ends in a slash once load() has cleaned the path
+        const QString prefix = dir.path.endsWith('/') ? dir.path : dir.path + '/';
+        for (const QString& name : dir.executables) {
+            // Earlier PATH entries shadow later ones, as in the shell
+            if (seen.contains(name)) continue;
+            seen.insert(name);
+
             LauncherItem item;
-            item.id = "path:" + file.fileName();
+            item.id = "path:" + name;
             // In a real scenario we might want full path, but "primary" is usually display name
-            item.primary = file.fileName();
-            item.secondary = file.absoluteFilePath();
+            item.primary = name;
+            item.secondary = prefix + name;
             item.iconKey = "application-x-executable";
-            item.exec = file.fileName(); 
+            item.exec = name; 
             item.terminal = false;
             item.selected = false;
-            items.push_back(item);
+            items.push_back(std::move(item));
         }
     }
     return items;
@@ -1,13 +1,38 @@
 #pragma once
 
+#include <QString>
+#include <QStringList>
 #include <vector>
 #include "../models/LauncherModel.h"
 
 /**
  * @class PathProvider
  * @brief Scans system PATH for executables.
+ *
+ * Directory listings are cached in path.cache under the cache directory
+ * and reused while the directory's mtime is unchanged, so a warm scan
+ * costs one stat per PATH entry. Listings are read with readdir() and
+ * its d_type, so only symlinks and unknown entries need a stat. A name
+ * found in several directories is listed once, from the first directory
+ * in PATH order, which is the binary a shell would run.
  */
 class PathProvider {
 public:
+    /** @brief Executables of one PATH directory. */
+    struct Directory {
+        QString path;
+        qint64 mtime = -1;          /**< Nanoseconds; -1 if the directory is missing */
+        QStringList executables;    /**< Sorted by name */
+    };
+
     static std::vector<LauncherItem> scan();
+
+    /** @brief PATH entries in order, absolute and clean, without duplicates. */
+    static QStringList pathDirs();
+    /** @brief Listings of every PATH directory, from the cache where fresh. */
+    static std::vector<Directory> load();
+    /** @brief Lists @p path from disk. */
+    static Directory listDirectory(const QString& path);
+    /** @brief One item per executable name, shadowed in PATH order. */
+    static std::vector<LauncherItem> merge(const std::vector<Directory>& dirs);
 };
@@ -0,0 +1,346 @@
+#include "ProcBatchReader.h"
+
+#ifdef HAVE_IO_URING
+
+#include <QDebug>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <liburing.h>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Marks the completions of cancel requests, which carry no slot
+constexpr __u64 CancelTag = ~__u64(0);
+// After a failure, how long to wait for each remaining completion
+constexpr long ReapTimeoutSec = 1;
+
+struct Ring {
+    io_uring ring;
+    bool initialized = false;
+    bool ready = false;             // False after a failure: batching is off for good
+    bool lost = false;              // Completions may still arrive; nothing here may be freed
+    std::vector<char> buffers;      // BatchSize file buffers
+    std::vector<struct statx> stats;
+    unsigned queued = 0;            // Entries prepared since the last complete()
+    unsigned slots[ProcBatchReader::BatchSize]; // Their slots, in submission order
+
+    Ring()
+    {
+        if (io_uring_queue_init(ProcBatchReader::BatchSize, &ring, 0) != 0) {
+            qInfo() << "ProcBatchReader: io_uring unavailable, reading /proc one by one";
+            return;
+        }
+        initialized = true;
+        io_uring_probe* probe = io_uring_get_probe_ring(&ring);
+        ready = probe && io_uring_opcode_supported(probe, IORING_OP_OPENAT) &&
+                io_uring_opcode_supported(probe, IORING_OP_STATX) &&
+                io_uring_opcode_supported(probe, IORING_OP_READ) &&
+                io_uring_opcode_supported(probe, IORING_OP_CLOSE);
+        if (probe) io_uring_free_probe(probe);
+        if (!ready) {
+            qInfo() << "ProcBatchReader: kernel lacks io_uring file opcodes, reading /proc one by one";
+            return;
+        }
+        buffers.resize(ProcBatchReader::BatchSize * ProcBatchReader::BufferSize);
+        stats.resize(ProcBatchReader::BatchSize);
+    }
+
+    ~Ring()
+    {
+        if (initialized) io_uring_queue_exit(&ring);
+    }
+
+    /**
+     * Submits the entries prepared with next() and hands each completion
+     * to @p handle(slot, result); entries that never ran get -ECANCELED.
+     *
+     * On failure the ring is retired, but only after every submitted
+     * entry was reaped (the rest cancelled), so no open or close completes
+     * behind the caller's back. If even that fails, lost is set.
+     */
+    template <typename Handle>
+    bool complete(Handle handle)
+    {
+        const unsigned count = std::exchange(queued, 0u);
+        if (count == 0) return true;
+        int submitted;
+        do {
+            submitted = io_uring_submit(&ring);
+        } while (submitted == -EINTR);
+        if (submitted < 0) submitted = 0;
+
+        // Entries left in the queue never run: the ring is retired before
+        // anything is submitted again
+        bool failed = submitted != static_cast<int>(count);
+        for (unsigned i = submitted; i < count; ++i) {
+            handle(slots[i], -ECANCELED);
+        }
+
+        bool reaped[ProcBatchReader::BatchSize] = {};
+        bool cancelled = false;
+        int pending = submitted;
+        while (pending > 0) {
+            io_uring_cqe* cqe;
+            int result;
+            do {
+                if (failed) {
+                    __kernel_timespec timeout{ReapTimeoutSec, 0};
+                    result = io_uring_wait_cqe_timeout(&ring, &cqe, &timeout);
+                } else {
+                    result = io_uring_wait_cqe(&ring, &cqe);
+                }
+            } while (result == -EINTR);
+
+            if (result < 0) {
+                failed = true;
+                // Cancel what is left once, then give up on a ring that
+                // still does not complete
+                if (cancelled || !cancel(count, submitted, reaped)) {
+                    lost = true;
+                    break;
+                }
+                cancelled = true;
+                continue;
+            }
+            const __u64 data = cqe->user_data;
+            const int res = cqe->res;
+            io_uring_cqe_seen(&ring, cqe);
+            if (data == CancelTag) continue;
+            reaped[data] = true;
+            handle(static_cast<unsigned>(data), res);
+            --pending;
+        }
+        return failed ? retire() : true;
+    }
+
+    /** Asks the kernel to cancel the submitted entries not reaped yet. */
+    bool cancel(unsigned count, int submitted, const bool* reaped)
+    {
+        // Only when everything was submitted: another submit would also
+        // send the entries still queued
+        if (submitted != static_cast<int>(count)) return true;
+        for (unsigned i = 0; i < count; ++i) {
+            if (reaped[slots[i]]) continue;
+            io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+            if (!sqe) break;
+            io_uring_prep_cancel(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(slots[i])), 0);
+            sqe->user_data = CancelTag;
+        }
+        int result;
+        do {
+            result = io_uring_submit(&ring);
+        } while (result == -EINTR);
+        return result >= 0;
+    }
+
+    bool retire()
+    {
+        qWarning() << "ProcBatchReader: io_uring failed, reading /proc one by one";
+        ready = false;
+        return false;
+    }
+
+    io_uring_sqe* next(unsigned slot)
+    {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        // The queue holds BatchSize entries and is drained after every phase
+        sqe->user_data = slot;
+        slots[queued++] = slot;
+        return sqe;
+    }
+};
+
+/**
+ * Rings shared by every thread. Scans run on the GUI thread and on pool
+ * threads that exit after 30 s idle; a ring per thread would be set up
+ * again (queue, probe, buffers) for nearly every scan. A scan takes an
+ * idle ring, or makes one, and gives it back: there are never more rings
+ * than concurrent scans.
+ */
+class RingPool {
+public:
+    static RingPool& instance()
+    {
+        static RingPool pool;
+        return pool;
+    }
+
+    /** Null once io_uring turned out unusable. */
+    std::unique_ptr<Ring> acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_disabled) return nullptr;
+            if (!m_idle.empty()) {
+                std::unique_ptr<Ring> ring = std::move(m_idle.back());
+                m_idle.pop_back();
+                return ring;
+            }
+        }
+        auto ring = std::make_unique<Ring>();
+        if (ring->ready) return ring;
+        release(std::move(ring));
+        return nullptr;
+    }
+
+    void release(std::unique_ptr<Ring> ring)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (ring->ready) {
+            m_idle.push_back(std::move(ring));
+            return;
+        }
+        // Unsupported or retired
+        m_disabled = true;
+        if (ring->lost) {
+            // The kernel may still write to its buffers: leak it
+            ring.release();
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Ring>> m_idle;
+    bool m_disabled = false;
+};
+
+/** An idle ring for the duration of one call. */
+class RingLease {
+public:
+    RingLease() : m_ring(RingPool::instance().acquire()) {}
+    ~RingLease()
+    {
+        if (m_ring) RingPool::instance().release(std::move(m_ring));
+    }
+    RingLease(const RingLease&) = delete;
+    RingLease& operator=(const RingLease&) = delete;
+
+    Ring* get() const { return m_ring.get(); }
+
+private:
+    std::unique_ptr<Ring> m_ring;
+};
+
+} // namespace
+
+bool ProcBatchReader::available()
+{
+    return RingLease().get() != nullptr;
+}
+
+size_t ProcBatchReader::readFiles(int procFd, const std::vector<int>& pids, const char* file,
+                                  const uid_t* owner, const Handler& handler)
+{
+    RingLease lease;
+    if (!lease.get()) return 0;
+    Ring& ring = *lease.get();
+
+    char names[BatchSize][32];
+    int fds[BatchSize];
+    int lengths[BatchSize];
+    bool wanted[BatchSize];
+
+    size_t done = 0;
+    while (done < pids.size()) {
+        const unsigned count = static_cast<unsigned>(std::min<size_t>(BatchSize, pids.size() - done));
+        for (unsigned i = 0; i < count; ++i) {
+            std::snprintf(names[i], sizeof(names[i]), "%d", pids[done + i]);
+            fds[i] = -1;
+            lengths[i] = 0;
+            wanted[i] = true;
+        }
+
+        // 1. Owners, like fstat() on the pid directory
+        if (owner) {
+            for (unsigned i = 0; i < count; ++i) {
+                io_uring_prep_statx(ring.next(i), procFd, names[i], 0, STATX_UID, &ring.stats[i]);
+            }
+            const bool ok = ring.complete([&](unsigned slot, int result) {
+                wanted[slot] = result == 0 && ring.stats[slot].stx_uid == *owner;
+            });
+            if (!ok) return done;
+        }
+
+        // Closes what is still open after a failed phase. Every submitted
+        // entry was reaped by then, so each descriptor here is open and ours.
+        // A lost ring may still complete anything: leaking beats closing a
+        // descriptor twice (by then it may belong to another thread).
+        auto closeRemaining = [&]() {
+            if (ring.lost) return;
+            for (unsigned i = 0; i < count; ++i) {
+                if (fds[i] >= 0) ::close(fds[i]);
+            }
+        };
+
+        // 2. Open <pid>/<file>
+        for (unsigned i = 0; i < count; ++i) {
+            if (!wanted[i]) continue;
+            std::snprintf(names[i], sizeof(names[i]), "%d/%s", pids[done + i], file);
+            io_uring_prep_openat(ring.next(i), procFd, names[i], O_RDONLY | O_CLOEXEC, 0);
+        }
+        bool ok = ring.complete([&](unsigned slot, int result) {
+            fds[slot] = result; // Negative: exited meanwhile
+        });
+
+        // 3. Read, one call each: procfs renders stat and cmdline in a
+        //    single read (up to a page)
+        if (ok) {
+            for (unsigned i = 0; i < count; ++i) {
+                if (fds[i] < 0) continue;
+                io_uring_prep_read(ring.next(i), fds[i], ring.buffers.data() + i * BufferSize,
+                                   BufferSize, 0);
+            }
+            ok = ring.complete([&](unsigned slot, int result) {
+                lengths[slot] = result;
+            });
+        }
+        if (!ok) {
+            closeRemaining();
+            return done;
+        }
+
+        // 4. Close what was opened. A close that ran, even with an error,
+        //    released the descriptor; one that never ran did not.
+        for (unsigned i = 0; i < count; ++i) {
+            if (fds[i] < 0) continue;
+            io_uring_prep_close(ring.next(i), fds[i]);
+        }
+        ok = ring.complete([&](unsigned slot, int result) {
+            if (result != -ECANCELED) fds[slot] = -1;
+        });
+        if (!ok) {
+            closeRemaining();
+            return done;
+        }
+
+        for (unsigned i = 0; i < count; ++i) {
+            if (lengths[i] > 0) {
+                handler(done + i, ring.buffers.data() + i * BufferSize, static_cast<size_t>(lengths[i]));
+            }
+        }
+        done += count;
+    }
+    return done;
+}
+
+#else
+
+bool ProcBatchReader::available()
+{
+    return false;
+}
+
+size_t ProcBatchReader::readFiles(int, const std::vector<int>&, const char*, const uid_t*, const Handler&)
+{
+    return 0;
+}
+
+#endif
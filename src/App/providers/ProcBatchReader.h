@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * @class ProcBatchReader
+ * @brief Reads a /proc/<pid> file of many processes with batched io_uring calls.
+ *
+ * The owner checks, opens, reads and closes of up to BatchSize processes
+ * are each submitted at once. Reading N processes then takes a few
+ * io_uring_enter() calls instead of three or four system calls each.
+ *
+ * This is only built with liburing (HAVE_IO_URING). It also needs a
+ * kernel that allows io_uring with the openat/statx/read/close opcodes
+ * (5.6+, and not disabled by sysctl or seccomp). Otherwise readFiles()
+ * handles nothing, and callers read the files one by one.
+ *
+ * Rings are pooled process-wide rather than per thread, so the pool
+ * threads that scans run on can come and go. Safe to call from any thread.
+ */
+class ProcBatchReader {
+public:
+    /**
+     * @brief Receives the file of @p pids[index]. @p data may be modified,
+     * but it is only valid during the call.
+     */
+    using Handler = std::function<void(size_t index, char* data, size_t length)>;
+
+    /** @brief Processes submitted together. */
+    static constexpr unsigned BatchSize = 128;
+    /** @brief Longest file read; longer ones are truncated. */
+    static constexpr size_t BufferSize = 4096;
+
+    /** @brief Whether io_uring can be used. */
+    static bool available();
+
+    /**
+     * @brief Reads <pid>/@p file for each of @p pids, below @p procFd.
+     *
+     * With @p owner set, processes of other users are skipped. Processes that
+     * exited meanwhile are skipped too.
+     *
+     * @return How many of @p pids (from the front) were handled. The caller
+     *         reads the rest itself; that is all of them without io_uring.
+     */
+    static size_t readFiles(int procFd, const std::vector<int>& pids, const char* file,
+                            const uid_t* owner, const Handler& handler);
+};
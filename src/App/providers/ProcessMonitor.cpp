@@ -0,0 +1,62 @@
+#include "ProcessMonitor.h"
+#include "ProcessTable.h"
+#include <chrono>
+#include <utility>
+
+ProcessMonitor::ProcessMonitor(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setInterval(SampleIntervalMs);
+    // Coarse: nothing depends on the exact tick, and wakeups can be batched
+    m_timer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &ProcessMonitor::sample);
+
+    // One snapshot at a time, off the GUI thread
+    m_pool.setMaxThreadCount(1);
+}
+
+void ProcessMonitor::start()
+{
+    sample();
+}
+
+void ProcessMonitor::setActive(bool active)
+{
+    if (active == m_timer.isActive()) return;
+    if (active) {
+        m_timer.start();
+    } else {
+        m_timer.stop();
+    }
+    sample();
+}
+
+void ProcessMonitor::sample()
+{
+    if (m_sampling) return;
+    m_sampling = true;
+
+    // The table is only read here, on its own thread
+    const bool listed = m_table && m_table->isActive();
+    const std::vector<int> pids = listed ? m_table->pids(true) : std::vector<int>();
+    m_pool.start([this, listed, pids]() {
+        ProcessProvider::CpuSnapshot snapshot = ProcessProvider::cpuSnapshot(listed ? &pids : nullptr);
+        // m_pool waits for this task before the object goes away, and the
+        // queued call is dropped with it
+        QMetaObject::invokeMethod(this, [this, snapshot = std::move(snapshot)]() mutable {
+            m_sampling = false;
+            m_previous = std::exchange(m_latest, std::move(snapshot));
+        }, Qt::QueuedConnection);
+    });
+}
+
+const ProcessProvider::CpuSnapshot* ProcessMonitor::baseline() const
+{
+    const qint64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const qint64 minWindow = static_cast<qint64>(MinWindowMs) * 1000000;
+
+    if (m_latest.time > 0 && now - m_latest.time >= minWindow) return &m_latest;
+    if (m_previous.time > 0) return &m_previous;
+    return m_latest.time > 0 ? &m_latest : nullptr;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include "ProcessProvider.h"
+
+class ProcessTable;
+
+/**
+ * @class ProcessMonitor
+ * @brief Background CPU sampler for top mode in the daemon.
+ *
+ * Takes a CpuSnapshot every SampleIntervalMs and keeps the last two, so
+ * opening top can measure CPU% against a baseline that is already a
+ * useful distance in the past instead of sampling twice while the user
+ * waits.
+ *
+ * Snapshots are read on a worker thread. The timer only runs while the
+ * launcher is shown; hiding takes one last snapshot, so the next open
+ * measures CPU% over the time it was hidden.
+ */
+class ProcessMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProcessMonitor(QObject *parent = nullptr);
+
+    /** @brief Takes the first snapshot; sampling then follows setActive(). */
+    void start();
+
+    /** @brief Samples every SampleIntervalMs while @p active (the launcher is shown). */
+    void setActive(bool active);
+
+    /** @brief Samples only the processes @p table lists, while it is active. */
+    void setProcessTable(ProcessTable* table) { m_table = table; }
+
+    /**
+     * @brief The newest snapshot at least MinWindowMs old, or nullptr
+     * before the first sample.
+     */
+    const ProcessProvider::CpuSnapshot* baseline() const;
+
+    static constexpr int SampleIntervalMs = 2000;
+    /** @brief Shorter windows resolve too few ticks to rank by. */
+    static constexpr int MinWindowMs = 250;
+
+private slots:
+    void sample();
+
+private:
+    QTimer m_timer;
+    QThreadPool m_pool;
+    bool m_sampling = false;        // A snapshot is being read; ticks meanwhile are skipped
+    ProcessTable* m_table = nullptr;
+    ProcessProvider::CpuSnapshot m_previous;
+    ProcessProvider::CpuSnapshot m_latest;
+};
@@ -1,132 +1,234 @@
 #include "ProcessProvider.h"
-#include <QDir>
-#include <QFile>
-#include <QTextStream>
+#include "ProcBatchReader.h"
 #include <QDebug>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <signal.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 
 struct ProcessInfo {
     int pid;
-    QString name;
-    QString cmdline;
+    char comm[64];              // From stat; the kernel caps it at 15 bytes
+    int commLength = 0;
     long unsigned int utime = 0;
     long unsigned int stime = 0;
     long long rss = 0;
-    double cpuUsage = 0.0;
+    unsigned long long starttime = 0;   // Ticks after boot; tells reused pids apart
+    double cpuUsage = 0.0;              // Percent of one core over the sample window
 };
 
-// Helper: Get system uptime/clk_tck for CPU calc
-static long getSysUptime() {
-    QFile f("/proc/uptime");
-    if (f.open(QIODevice::ReadOnly)) {
-        QString s = f.readAll();
-        return s.split(" ").first().toDouble();
+static long Hertz = sysconf(_SC_CLK_TCK);
+
+static qint64 monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Helper: Reads all of (small) file @p name below @p dirFd into @p buffer.
+// Returns the length, or -1. Longer files are truncated to the buffer.
+static ssize_t readAt(int dirFd, const char* name, char* buffer, size_t size) {
+    const int fd = ::openat(dirFd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    size_t length = 0;
+    while (length < size) {
+        const ssize_t n = ::read(fd, buffer + length, size - length);
+        if (n <= 0) break;
+        length += static_cast<size_t>(n);
     }
-    return 0;
+    ::close(fd);
+    return static_cast<ssize_t>(length);
 }
 
-static long Hertz = sysconf(_SC_CLK_TCK);
+// Helper: Parses a /proc directory name; -1 if it is not a pid
+static int parsePid(const char* name) {
+    int pid = 0;
+    for (const char* c = name; *c; ++c) {
+        if (*c < '0' || *c > '9') return -1;
+        pid = pid * 10 + (*c - '0');
+    }
+    return name[0] ? pid : -1;
+}
 
-// Helper: Read a single process from /proc/[pid]
-static bool readProc(const QString& pidStr, ProcessInfo& out) {
-    bool ok;
-    int pid = pidStr.toInt(&ok);
-    if (!ok) return false;
-    out.pid = pid;
-
-    // Read cmdline
-    QFile fCmd("/proc/" + pidStr + "/cmdline");
-    if (fCmd.open(QIODevice::ReadOnly)) {
-        QByteArray data = fCmd.readAll();
-        // cmdline is null-delimited, replace with spaces for display
-        out.cmdline = QString::fromUtf8(data).replace('\0', ' ').trimmed();
-        fCmd.close();
-    }
-
-    // Read stat for CPU/Mem/Name
-    QFile fStat("/proc/" + pidStr + "/stat");
-    if (fStat.open(QIODevice::ReadOnly)) {
-        QString content = fStat.readAll();
-        // Format of /proc/[pid]/stat is tricky because comm can contain spaces/parens.
-        // Usually: pid (comm) state ppid ...
-        int firstParen = content.indexOf('(');
-        int lastParen = content.lastIndexOf(')');
-        if (firstParen != -1 && lastParen != -1) {
-            out.name = content.mid(firstParen + 1, lastParen - firstParen - 1);
-            
-            // The rest after lastParen
-            QString rest = content.mid(lastParen + 2);
-            QStringList parts = rest.split(' ', Qt::SkipEmptyParts);
-            // parts[0] is state.
-            // utime is parts[11], stime is parts[12] (0-indexed relative to rest)
-            // But 'rest' starts at field 3 (state maps to 3 in standard man proc).
-            // Actually, man 5 proc:
-            // (1) pid, (2) comm, (3) state, ...
-            // So after ')', the next item is field 3 (state).
-            // utime is field 14.
-            // stime is field 15.
-            // rss is field 24.
-            
-            // Indices in 'parts' (which starts at field 3):
-            // Field 14 corresponds to index 14 - 3 = 11.
-            // Field 15 corresponds to index 15 - 3 = 12.
-            // Field 24 corresponds to index 24 - 3 = 21.
-            
-            if (parts.size() >= 22) {
-                out.utime = parts[11].toULong();
-                out.stime = parts[12].toULong();
-                out.rss = parts[21].toLongLong();
-            }
+// Helper: Parses /proc/[pid]/stat from @p data into @p out
+static bool parseStat(const char* data, size_t length, ProcessInfo& out) {
+    // Format: pid (comm) state ppid ... comm may contain spaces and parens,
+    // so it ends at the *last* ')'.
+    const char* open = static_cast<const char*>(std::memchr(data, '(', length));
+    const char* close = static_cast<const char*>(::memrchr(data, ')', length));
+    if (!open || !close || close < open) return false;
+
+    out.commLength = static_cast<int>(std::min<ptrdiff_t>(close - open - 1, sizeof(out.comm)));
+    std::memcpy(out.comm, open + 1, out.commLength);
+
+    // Fields after ')' start at (3) state (man 5 proc). We need (14) utime,
+    // (15) stime, (22) starttime and (24) rss.
+    const char* p = close + 1;
+    const char* end = data + length;
+    for (int field = 3; field <= 24; ++field) {
+        while (p < end && *p == ' ') ++p;
+        if (p == end) return false;
+
+        if (field == 14 || field == 15 || field == 22 || field == 24) {
+            long long value = 0;
+            bool negative = *p == '-';
+            if (negative) ++p;
+            while (p < end && *p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+            if (negative) value = -value;
+            if (field == 14) out.utime = static_cast<unsigned long>(value);
+            else if (field == 15) out.stime = static_cast<unsigned long>(value);
+            else if (field == 22) out.starttime = static_cast<unsigned long long>(value);
+            else out.rss = value;
         }
+        while (p < end && *p != ' ') ++p;
     }
-    
-    if (out.name.isEmpty() && out.cmdline.isEmpty()) return false;
-    if (out.name.isEmpty()) out.name = out.cmdline.split(' ').first();
-    
     return true;
 }
 
-std::vector<LauncherItem> ProcessProvider::scan(bool topMode, int limit, SortMode sort, bool showSystem) {
+// Helper: A cmdline file's contents, NULs shown as spaces
+static QString formatCmdline(char* buffer, ssize_t length) {
+    // cmdline is null-delimited, replace with spaces for display
+    std::replace(buffer, buffer + length, '\0', ' ');
+    while (length > 0 && (buffer[length - 1] == ' ' || buffer[length - 1] == '\n')) --length;
+    return QString::fromUtf8(buffer, length);
+}
+
+// Helper: Command line of @p pid, NULs shown as spaces
+static QString readCmdline(int procFd, int pid) {
+    char path[32];
+    std::snprintf(path, sizeof(path), "%d/cmdline", pid);
+    char buffer[ProcBatchReader::BufferSize];
+    ssize_t length = readAt(procFd, path, buffer, sizeof(buffer));
+    if (length <= 0) return QString();
+    return formatCmdline(buffer, length);
+}
+
+// Helper: Parses one stat file into @p out
+static void addProc(int pid, const char* data, size_t length, std::vector<ProcessInfo>& out) {
+    ProcessInfo info;
+    info.pid = pid;
+    if (parseStat(data, length, info)) {
+        out.push_back(info);
+    }
+}
+
+// Helper: Reads process @p pid into @p out. With @p owner set, processes of
+// other users are skipped.
+static void readProc(int procFd, int pid, const uid_t* owner, std::vector<ProcessInfo>& out) {
+    char name[16];
+    std::snprintf(name, sizeof(name), "%d", pid);
+    char buffer[2048];
+    ssize_t length;
+    if (owner) {
+        const int pidFd = ::openat(procFd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (pidFd < 0) return; // Exited meanwhile
+
+        // Check owner first if not showSystem
+        struct stat st;
+        if (::fstat(pidFd, &st) != 0 || st.st_uid != *owner) {
+            ::close(pidFd);
+            return;
+        }
+        length = readAt(pidFd, "stat", buffer, sizeof(buffer));
+        ::close(pidFd);
+    } else {
+        // Nothing to check: one open instead of two
+        char path[32];
+        std::snprintf(path, sizeof(path), "%d/stat", pid);
+        length = readAt(procFd, path, buffer, sizeof(buffer));
+    }
+
+    if (length > 0) {
+        addProc(pid, buffer, static_cast<size_t>(length), out);
+    }
+}
+
+// Helper: Reads every process (of @p showSystem ? anyone : us) into @p out,
+// or only @p pids if given. Returns the /proc DIR, still open for reading
+// cmdlines, or nullptr.
+static DIR* readProcs(bool showSystem, std::vector<ProcessInfo>& out, const std::vector<int>* pids) {
+    // Everything below is read relative to one /proc descriptor with fixed
+    // stack buffers: no path strings, no QFile, one fstat per process.
+    DIR* procDir = ::opendir("/proc");
+    if (!procDir) {
+        qWarning() << "ProcessProvider: cannot open /proc";
+        return nullptr;
+    }
+    const int procFd = ::dirfd(procDir);
+
+    // A ProcessTable list was already checked for owners
+    const uid_t myUid = getuid();
+    const uid_t* owner = (pids || showSystem) ? nullptr : &myUid;
+    std::vector<int> walked;
+    if (!pids) {
+        while (const dirent* entry = ::readdir(procDir)) {
+            // Must be numeric
+            const int pid = parsePid(entry->d_name);
+            if (pid >= 0) walked.push_back(pid);
+        }
+        pids = &walked;
+    }
+    out.reserve(pids->size());
+
+    // Batched through io_uring where available; the rest one by one
+    const size_t batched = ProcBatchReader::readFiles(procFd, *pids, "stat", owner,
+        [&out, pids](size_t index, char* data, size_t length) { addProc((*pids)[index], data, length, out); });
+    for (size_t i = batched; i < pids->size(); ++i) {
+        readProc(procFd, (*pids)[i], owner, out);
+    }
+    return procDir;
+}
+
+ProcessProvider::CpuSnapshot ProcessProvider::cpuSnapshot(const std::vector<int>* pids) {
+    CpuSnapshot snapshot;
+    std::vector<ProcessInfo> procs;
+    snapshot.time = monotonicNs();
+    if (DIR* procDir = readProcs(true, procs, pids)) {
+        ::closedir(procDir);
+    }
+
+    snapshot.ticks.reserve(static_cast<qsizetype>(procs.size()));
+    for (const auto& p : procs) {
+        snapshot.ticks.insert(p.pid, {p.utime + p.stime, p.starttime});
+    }
+    return snapshot;
+}
+
+std::vector<LauncherItem> ProcessProvider::scan(bool topMode, int limit, SortMode sort, bool showSystem,
+                                                const CpuSnapshot* baseline, CpuSnapshot* sample,
+                                                const std::vector<int>* pids) {
     std::vector<LauncherItem> items;
     std::vector<ProcessInfo> procs;
-    
-    QDir procDir("/proc");
-    QStringList entries = procDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-    
-    int myUid = getuid();
 
-    for (const QString& pidStr : entries) {
-        // Must be numeric
-        bool isNum;
-        pidStr.toInt(&isNum);
-        if (!isNum) continue;
+    const qint64 now = monotonicNs();
+    DIR* procDir = readProcs(showSystem, procs, pids);
+    if (!procDir) return items;
+    const int procFd = ::dirfd(procDir);
 
-        // Check owner first if not showSystem
-        if (!showSystem) {
-             QFileInfo info("/proc/" + pidStr);
-             if (info.ownerId() != (uint)myUid) continue;
+    if (sample) {
+        // Added to: a set may scan both top and kill into one sample
+        sample->time = now;
+        sample->ticks.reserve(sample->ticks.size() + static_cast<qsizetype>(procs.size()));
+        for (const auto& p : procs) {
+            sample->ticks.insert(p.pid, {p.utime + p.stime, p.starttime});
         }
+    }
 
-        ProcessInfo info;
-        if (readProc(pidStr, info)) {
-            // Calculate pseudo CPU usage (Process Utime+Stime / Uptime) - wait, that's avg over life.
-            // For a *snapshot* "top", we really need Delta. 
-            // Since we can't wait for a delta, we'll use "Avg CPU over lifetime" or just raw Memory?
-            // "Top" usually shows current usage.
-            // Without a delta (stateful), showing CPU is misleading for long running processes.
-            // BUT, `ps aux` shows %CPU. How? "cpu time / elapsed time".
-            // Let's stick to Memory for now as the default robust sort, or just lifetime CPU intensity.
-            // Or... RFC said "Snapshot on open".
-            // Let's calculate Lifetime Usage = (utime+stime) / Hertz / (ProcessStartTime - SystemBootTime).
-            // Accessing starttime is complex (field 22). 
-            // Let's assume RSS for sorting if CPU is too hard for a quick snapshot.
-            // Actually config lets user sort.
-            
-            // Lets just store raw values and sort.
-            procs.push_back(info);
+    // CPU% = ticks spent since the baseline / ticks that elapsed
+    const double windowTicks = baseline ? (now - baseline->time) / 1e9 * Hertz : 0;
+    if (windowTicks > 0) {
+        for (auto& p : procs) {
+            const quint64 ticks = p.utime + p.stime;
+            auto it = baseline->ticks.constFind(p.pid);
+            // Started within the window (or a reused pid): all its ticks are recent
+            const quint64 before = (it != baseline->ticks.constEnd() && it->second == p.starttime)
+                                       ? std::min(it->first, ticks) : 0;
+            p.cpuUsage = (ticks - before) / windowTicks * 100.0;
         }
     }
 
@@ -136,9 +238,11 @@ std::vector<LauncherItem> ProcessProvider::scan(bool topMode, int limit, SortMod
             return a.rss > b.rss;
         });
     } else {
-        // CPU (using raw ticks as proxy for "hogs over time" since we lack delta)
+        // CPU: the rate over the window; lifetime ticks break ties (and
+        // are all there is if the window is empty)
         std::sort(procs.begin(), procs.end(), [](const ProcessInfo& a, const ProcessInfo& b){
-             return (a.utime + a.stime) > (b.utime + b.stime);
+            if (a.cpuUsage != b.cpuUsage) return a.cpuUsage > b.cpuUsage;
+            return (a.utime + a.stime) > (b.utime + b.stime);
         });
     }
     
@@ -147,14 +251,44 @@ std::vector<LauncherItem> ProcessProvider::scan(bool topMode, int limit, SortMod
         procs.resize(limit);
     }
 
-    // Convert to LauncherItems
-    for (const auto& p : procs) {
+    // Convert to LauncherItems. Strings are only built (and cmdline only
+    // read) for the processes that are actually listed.
+    std::vector<int> listed;
+    listed.reserve(procs.size());
+    for (const auto& p : procs) listed.push_back(p.pid);
+    std::vector<QString> cmdlines(procs.size());
+    const size_t batched = ProcBatchReader::readFiles(procFd, listed, "cmdline", nullptr,
+        [&cmdlines](size_t index, char* data, size_t length) {
+            cmdlines[index] = formatCmdline(data, static_cast<ssize_t>(length));
+        });
+    for (size_t i = batched; i < procs.size(); ++i) {
+        cmdlines[i] = readCmdline(procFd, procs[i].pid);
+    }
+
+    items.reserve(procs.size());
+    for (size_t i = 0; i < procs.size(); ++i) {
+        const ProcessInfo& p = procs[i];
+        const QString& cmdline = cmdlines[i];
+        QString name = QString::fromUtf8(p.comm, p.commLength);
+        if (name.isEmpty()) name = cmdline.section(' ', 0, 0);
+
         LauncherItem item;
         item.id = "proc:" + QString::number(p.pid);
-        item.primary = p.name;
+        item.primary = name;
         // Format details: PID - RES: X MB
         double rssMb = (p.rss * 4096) / 1024.0 / 1024.0; // RSS is usually pages (4kb)
-        item.secondary = QString("PID: %1 | MEM: %2 MB | %3").arg(p.pid).arg(rssMb, 0, 'f', 1).arg(p.cmdline);
+        // One layout per mode, whether or not there is a baseline yet: the
+        // text is searched, and rows are diffed by it on every refresh
+        if (topMode && windowTicks > 0) {
+            item.secondary = QString("PID: %1 | CPU: %2% | MEM: %3 MB | %4")
+                                 .arg(p.pid).arg(p.cpuUsage, 0, 'f', 1).arg(rssMb, 0, 'f', 1).arg(cmdline);
+        } else if (topMode) {
+            // Filled in by the next scan
+            item.secondary = QString("PID: %1 | CPU: -- | MEM: %2 MB | %3")
+                                 .arg(p.pid).arg(rssMb, 0, 'f', 1).arg(cmdline);
+        } else {
+            item.secondary = QString("PID: %1 | MEM: %2 MB | %3").arg(p.pid).arg(rssMb, 0, 'f', 1).arg(cmdline);
+        }
         item.iconKey = "application-x-executable"; // Could try to map p.name to desktop icon?
         
         // exec is empty? Or "kill" command?
@@ -163,8 +297,9 @@ std::vector<LauncherItem> ProcessProvider::scan(bool topMode, int limit, SortMod
         item.exec = "kill:" + QString::number(p.pid); 
         item.terminal = false;
         
-        items.push_back(item);
+        items.push_back(std::move(item));
     }
+    ::closedir(procDir);
     
     return items;
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <QHash>
+#include <QPair>
 #include <QString>
 #include "../models/LauncherModel.h"
 
@@ -12,8 +14,37 @@ class ProcessProvider {
 public:
     enum SortMode { CPU, MEMORY };
 
-    /** @brief Returns list of processes, optionally sorted by usage. */
-    static std::vector<LauncherItem> scan(bool topMode, int limit, SortMode sort, bool showSystem);
+    /** @brief CPU ticks of every process at one moment, the baseline for CPU%. */
+    struct CpuSnapshot {
+        qint64 time = 0;    /**< steady_clock, ns; 0 if never taken */
+        QHash<int, QPair<quint64, quint64>> ticks; /**< pid -> (utime + stime, starttime) */
+    };
+
+    /** @brief Ticks of every process, or of @p pids only (see ProcessTable). */
+    static CpuSnapshot cpuSnapshot(const std::vector<int>* pids = nullptr);
+
+    /**
+     * @brief Wait before a second scan when the first had no baseline. Ticks
+     * are 1/Hertz s (usually 10 ms), so this resolves CPU% in steps of 5%.
+     */
+    static constexpr int FirstSampleMs = 200;
+
+    /**
+     * @brief Returns list of processes, optionally sorted by usage.
+     *
+     * CPU% is measured from @p baseline to now. Without one, processes are
+     * ranked by lifetime CPU time and top leaves the CPU% blank; a scan
+     * FirstSampleMs later, against this one's @p sample, fills it in.
+     * Kill rows never show CPU%; it only orders them.
+     * @p sample, if given, receives the ticks this scan read, as the
+     * baseline of the next one. @p pids, if given, replaces the walk of
+     * /proc: the processes to read, already filtered by owner (see
+     * ProcessTable).
+     */
+    static std::vector<LauncherItem> scan(bool topMode, int limit, SortMode sort, bool showSystem,
+                                          const CpuSnapshot* baseline = nullptr,
+                                          CpuSnapshot* sample = nullptr,
+                                          const std::vector<int>* pids = nullptr);
     
     /** @brief Helper to kill a process. */
     static bool killProcess(int pid, int signal);
@@ -0,0 +1,222 @@
+#include "ProcessTable.h"
+#include <QDebug>
+#include <QSocketNotifier>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// proc_event::what values; newer kernel headers moved the enum out of the
+// struct, so neither spelling compiles everywhere
+constexpr __u32 EventNone = 0x00000000;
+constexpr __u32 EventFork = 0x00000001;
+constexpr __u32 EventUid = 0x00000004;
+constexpr __u32 EventExit = 0x80000000;
+
+// Parses a /proc directory name; -1 if it is not a pid
+int parsePid(const char* name)
+{
+    int pid = 0;
+    for (const char* c = name; *c; ++c) {
+        if (*c < '0' || *c > '9') return -1;
+        pid = pid * 10 + (*c - '0');
+    }
+    return name[0] ? pid : -1;
+}
+
+// Asks the connector to start sending process events to @p fd
+bool subscribe(int fd)
+{
+    alignas(nlmsghdr) char buffer[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))] = {};
+    auto* header = reinterpret_cast<nlmsghdr*>(buffer);
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+    header->nlmsg_type = NLMSG_DONE;
+    header->nlmsg_pid = static_cast<__u32>(::getpid());
+
+    auto* message = static_cast<cn_msg*>(NLMSG_DATA(header));
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->len = sizeof(proc_cn_mcast_op);
+    const proc_cn_mcast_op op = PROC_CN_MCAST_LISTEN;
+    std::memcpy(message->data, &op, sizeof(op));
+
+    return ::send(fd, buffer, header->nlmsg_len, 0) == static_cast<ssize_t>(header->nlmsg_len);
+}
+
+} // namespace
+
+ProcessTable::ProcessTable(QObject *parent)
+    : QObject(parent)
+    , m_uid(::getuid())
+{
+}
+
+ProcessTable::~ProcessTable()
+{
+    stop();
+}
+
+bool ProcessTable::start()
+{
+    if (m_socket >= 0) return true;
+
+    const int fd = ::socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0) {
+        qInfo() << "ProcessTable: netlink unavailable, scanning /proc instead";
+        return false;
+    }
+
+    sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+    // Joining the group needs CAP_NET_ADMIN; most sessions get EPERM here
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || !subscribe(fd)) {
+        qInfo() << "ProcessTable: proc connector unavailable (" << std::strerror(errno)
+                << "), scanning /proc instead";
+        ::close(fd);
+        return false;
+    }
+
+    m_socket = fd;
+    m_notifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &ProcessTable::readEvents);
+
+    // Events are queued from here on, so nothing starts unseen between the
+    // walk and the first event we read
+    rebuild();
+    qInfo() << "ProcessTable: tracking" << m_owners.size() << "processes via the proc connector";
+    return true;
+}
+
+void ProcessTable::stop()
+{
+    if (m_notifier) {
+        // May run from the notifier's own signal
+        m_notifier->setEnabled(false);
+        m_notifier->deleteLater();
+        m_notifier = nullptr;
+    }
+    if (m_socket >= 0) {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+    m_owners.clear();
+}
+
+std::vector<int> ProcessTable::pids(bool showSystem) const
+{
+    std::vector<int> result;
+    result.reserve(static_cast<size_t>(m_owners.size()));
+    for (auto it = m_owners.constBegin(); it != m_owners.constEnd(); ++it) {
+        if (showSystem || it.value() == m_uid) result.push_back(it.key());
+    }
+    return result;
+}
+
+bool ProcessTable::readOwner(int pid, uint& uid) const
+{
+    char name[16];
+    std::snprintf(name, sizeof(name), "/proc/%d", pid);
+    struct stat st;
+    if (::stat(name, &st) != 0) return false;
+    uid = st.st_uid;
+    return true;
+}
+
+void ProcessTable::rebuild()
+{
+    m_owners.clear();
+    DIR* procDir = ::opendir("/proc");
+    if (!procDir) return;
+    const int procFd = ::dirfd(procDir);
+
+    while (const dirent* entry = ::readdir(procDir)) {
+        const int pid = parsePid(entry->d_name);
+        if (pid < 0) continue;
+        struct stat st;
+        if (::fstatat(procFd, entry->d_name, &st, 0) == 0) {
+            m_owners.insert(pid, st.st_uid);
+        }
+    }
+    ::closedir(procDir);
+}
+
+void ProcessTable::readEvents()
+{
+    alignas(nlmsghdr) char buffer[8192];
+    while (true) {
+        sockaddr_nl from = {};
+        socklen_t fromLength = sizeof(from);
+        const ssize_t length = ::recvfrom(m_socket, buffer, sizeof(buffer), 0,
+                                          reinterpret_cast<sockaddr*>(&from), &fromLength);
+        if (length < 0) {
+            if (errno == ENOBUFS) {
+                // The socket overran and events were dropped: start over
+                qWarning() << "ProcessTable: lost process events, reloading from /proc";
+                rebuild();
+                continue;
+            }
+            return; // EAGAIN: drained
+        }
+        if (length == 0) return;
+        // Only the kernel may tell us about processes
+        if (from.nl_pid != 0) continue;
+
+        int remaining = static_cast<int>(length);
+        for (auto* header = reinterpret_cast<nlmsghdr*>(buffer); NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_NOOP) continue;
+            if (header->nlmsg_len < NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_event))) continue;
+
+            const auto* message = static_cast<const cn_msg*>(NLMSG_DATA(header));
+            if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC) continue;
+            proc_event event;
+            std::memcpy(&event, message->data, sizeof(event));
+
+            switch (static_cast<__u32>(event.what)) {
+            case EventNone:
+                if (event.event_data.ack.err != 0) {
+                    qWarning() << "ProcessTable: subscription refused, scanning /proc instead";
+                    stop();
+                    return;
+                }
+                break;
+            case EventFork: {
+                const auto& fork = event.event_data.fork;
+                if (fork.child_pid != fork.child_tgid) break; // A new thread
+                // A child starts out with its parent's credentials
+                auto parent = m_owners.constFind(fork.parent_tgid);
+                uint uid;
+                if (parent != m_owners.constEnd()) {
+                    m_owners.insert(fork.child_tgid, parent.value());
+                } else if (readOwner(fork.child_tgid, uid)) {
+                    m_owners.insert(fork.child_tgid, uid);
+                }
+                break;
+            }
+            case EventUid:
+                // setuid() and setuid executables
+                m_owners.insert(event.event_data.id.process_tgid, event.event_data.id.e.euid);
+                break;
+            case EventExit: {
+                const auto& exit = event.event_data.exit;
+                if (exit.process_pid == exit.process_tgid) {
+                    m_owners.remove(exit.process_tgid);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+}
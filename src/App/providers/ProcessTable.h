@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <vector>
+
+class QSocketNotifier;
+
+/**
+ * @class ProcessTable
+ * @brief Resident table of processes and their owners for the daemon.
+ *
+ * Kept current from the kernel's proc connector (fork, exit and uid
+ * change events over netlink), so top and kill read the processes it
+ * lists instead of walking /proc and checking every owner.
+ *
+ * Listening needs CAP_NET_ADMIN. Without it the table stays inactive and
+ * scans walk /proc, on every open and refresh tick, as before.
+ */
+class ProcessTable : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProcessTable(QObject *parent = nullptr);
+    ~ProcessTable() override;
+
+    /** @brief Subscribes to process events; false if netlink is unavailable. */
+    bool start();
+
+    /** @brief Whether events keep the table current. */
+    bool isActive() const { return m_socket >= 0; }
+
+    /** @brief Our processes, or everyone's with @p showSystem. */
+    std::vector<int> pids(bool showSystem) const;
+
+private slots:
+    void readEvents();
+
+private:
+    /** @brief Reloads the table from /proc, after subscribing or losing events. */
+    void rebuild();
+    void stop();
+    /** @brief Owner of @p pid from /proc, for processes whose parent is unknown. */
+    bool readOwner(int pid, uint& uid) const;
+
+    int m_socket = -1;
+    QSocketNotifier* m_notifier = nullptr;
+    QHash<int, uint> m_owners;   /**< tgid -> effective uid */
+    uint m_uid = 0;
+};
@@ -1,88 +1,318 @@
 #include "SSHProvider.h"
-#include <QFile>
-#include <QTextStream>
+#include <QDataStream>
+#include <QDebug>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
 #include <QStandardPaths>
-#include <QRegularExpression>
-#include <QDebug>
-#include <QProcessEnvironment>
+#include <algorithm>
+#include <cstring>
+#include <glob.h>
+#include <sys/stat.h>
 
-std::vector<LauncherItem> SSHProvider::scan(const QString& terminalCmd, bool parseKnownHosts) {
-    std::vector<LauncherItem> items;
-    QStringList seenHosts;
-    
-    auto addHost = [&](const QString& host, const QString& alias, const QString& user) {
-        if (seenHosts.contains(host) && alias.isEmpty()) return; // Dedup
-        seenHosts.append(host);
-        
-        LauncherItem item;
-        item.id = "ssh:" + host;
-        
-        if (!alias.isEmpty()) {
-            item.primary = alias;
-            item.secondary = "SSH -> " + host + (user.isEmpty() ? "" : " ("+user+")");
-        } else {
-            item.primary = host;
-            item.secondary = "SSH Host" + (user.isEmpty() ? "" : " ("+user+")");
+namespace {
+    // Bump whenever the stream layout changes
+    constexpr quint32 CacheMagic = 0x41574553; // "AWES"
+    constexpr quint32 CacheVersion = 1;
+
+    // Include nesting ssh itself accepts (READCONF_MAX_DEPTH)
+    constexpr int MaxIncludeDepth = 16;
+
+    QString cachePath() {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/awelauncher/ssh.cache";
+    }
+
+    QString sshDir() {
+        return QDir::homePath() + "/.ssh";
+    }
+
+    // Nanosecond mtime, or -1 if @p path is gone
+    qint64 mtimeOf(const QString& path) {
+        struct stat st;
+        if (::stat(QFile::encodeName(path).constData(), &st) != 0) return -1;
+        return static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+
+    // Host patterns (*.example.com, !bastion) name no host to connect to
+    bool isPattern(QStringView name) {
+        return name.contains(u'*') || name.contains(u'?') || name.startsWith(u'!');
+    }
+
+    // Arguments of a config line: separated by whitespace, "quoted" ones may
+    // contain it
+    QStringList splitArguments(QStringView text) {
+        QStringList args;
+        qsizetype i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && text[i].isSpace()) ++i;
+            if (i == text.size()) break;
+            if (text[i] == u'"') {
+                const qsizetype close = text.indexOf(u'"', i + 1);
+                const qsizetype end = close < 0 ? text.size() : close;
+                args << text.mid(i + 1, end - i - 1).toString();
+                i = end + 1;
+            } else {
+                const qsizetype start = i;
+                while (i < text.size() && !text[i].isSpace()) ++i;
+                args << text.mid(start, i - start).toString();
+            }
         }
-        
-        item.iconKey = "utilities-terminal";
-        
-        // Determine Terminal Command
-        // Priority: Passed cmd (config/xdg) > $TERM
-        // LauncherController handles terminal wrapping if item.terminal is true.
-        // We just need to provide the raw command.
-        item.exec = "ssh " + host;
-        item.terminal = true;
-        
-        // item.terminal handled above
-        items.push_back(item);
+        return args;
+    }
+
+    QDataStream& operator<<(QDataStream& out, const SSHProvider::Source& source) {
+        return out << source.path << source.mtime;
+    }
+
+    QDataStream& operator>>(QDataStream& in, SSHProvider::Source& source) {
+        return in >> source.path >> source.mtime;
+    }
+
+    SSHProvider::Hosts readCache() {
+        SSHProvider::Hosts hosts;
+        QFile file(cachePath());
+        if (!file.open(QIODevice::ReadOnly)) return hosts;
+
+        QDataStream in(&file);
+        quint32 magic = 0, version = 0, count = 0;
+        in >> magic >> version;
+        if (magic != CacheMagic || version != CacheVersion) return hosts;
+        in.setVersion(QDataStream::Qt_6_0);
+
+        in >> count;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            in >> hosts.sources.emplace_back();
+        }
+        in >> hosts.knownHostsRead >> hosts.configHosts >> hosts.knownHosts;
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "Ignoring corrupt SSH cache" << file.fileName();
+            return SSHProvider::Hosts();
+        }
+        return hosts;
+    }
+
+    void writeCache(const SSHProvider::Hosts& hosts) {
+        QDir().mkpath(QFileInfo(cachePath()).path());
+        QSaveFile file(cachePath());
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Failed to write SSH cache" << file.fileName();
+            return;
+        }
+
+        QDataStream out(&file);
+        out << CacheMagic << CacheVersion;
+        out.setVersion(QDataStream::Qt_6_0);
+        out << quint32(hosts.sources.size());
+        for (const auto& source : hosts.sources) out << source;
+        out << hosts.knownHostsRead << hosts.configHosts << hosts.knownHosts;
+        file.commit();
+    }
+
+    /** Collects Host aliases from a config file and everything it includes. */
+    class ConfigReader {
+    public:
+        ConfigReader(SSHProvider::Hosts& hosts, QSet<QString>& seen)
+            : m_hosts(hosts), m_seen(seen) {}
+
+        void readFile(const QString& path, int depth) {
+            m_hosts.sources.push_back({path, mtimeOf(path)});
+
+            // Cycles, and files included twice, are read once
+            const QString canonical = QFileInfo(path).canonicalFilePath();
+            if (canonical.isEmpty() || m_visited.contains(canonical)) return;
+            m_visited.insert(canonical);
+
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly)) return;
+            const QByteArray data = file.readAll();
+
+            for (qsizetype start = 0; start < data.size();) {
+                qsizetype end = data.indexOf('\n', start);
+                if (end < 0) end = data.size();
+                const QString line = QString::fromUtf8(data.constData() + start, end - start).trimmed();
+                start = end + 1;
+                if (line.isEmpty() || line.startsWith(u'#')) continue;
+
+                // "Keyword args" or "Keyword=args"; keywords are case-insensitive
+                qsizetype split = 0;
+                while (split < line.size() && !line[split].isSpace() && line[split] != u'=') ++split;
+                const QStringView keyword = QStringView(line).left(split);
+                QStringView rest = QStringView(line).mid(split).trimmed();
+                if (rest.startsWith(u'=')) rest = rest.mid(1).trimmed();
+
+                if (keyword.compare(QLatin1String("Host"), Qt::CaseInsensitive) == 0) {
+                    for (const QString& alias : splitArguments(rest)) {
+                        if (!isPattern(alias) && !m_seen.contains(alias)) {
+                            m_seen.insert(alias);
+                            m_hosts.configHosts << alias;
+                        }
+                    }
+                } else if (keyword.compare(QLatin1String("Include"), Qt::CaseInsensitive) == 0) {
+                    for (const QString& pattern : splitArguments(rest)) {
+                        include(pattern, depth);
+                    }
+                }
+            }
+        }
+
+    private:
+        void include(const QString& pattern, int depth) {
+            if (depth >= MaxIncludeDepth) {
+                qWarning() << "SSHProvider: Include nested too deeply, skipping" << pattern;
+                return;
+            }
+
+            // As in ssh: ~ is the home directory, relative paths are in ~/.ssh
+            QString path = pattern;
+            if (path.startsWith(u'~')) {
+                path = QDir::homePath() + path.mid(1);
+            } else if (QDir::isRelativePath(path)) {
+                path = sshDir() + "/" + path;
+            }
+
+            const auto wildcard = std::find_if(path.cbegin(), path.cend(), [](QChar c) {
+                return c == u'*' || c == u'?' || c == u'[';
+            });
+            if (wildcard == path.cend()) {
+                readFile(path, depth + 1);
+                return;
+            }
+
+            // New matches change the mtime of the directory they appear in:
+            // the last one without wildcards, and each one that matched
+            QSet<QString> stamped;
+            auto stamp = [this, &stamped](const QString& dir) {
+                if (stamped.contains(dir)) return;
+                stamped.insert(dir);
+                m_hosts.sources.push_back({dir, mtimeOf(dir)});
+            };
+            stamp(path.left(path.lastIndexOf(u'/', wildcard - path.cbegin())));
+
+            glob_t matches;
+            if (::glob(QFile::encodeName(path).constData(), 0, nullptr, &matches) == 0) {
+                for (size_t i = 0; i < matches.gl_pathc; ++i) {
+                    const QString match = QFile::decodeName(matches.gl_pathv[i]);
+                    stamp(QFileInfo(match).path());
+                    readFile(match, depth + 1);
+                }
+            }
+            ::globfree(&matches);
+        }
+
+        SSHProvider::Hosts& m_hosts;
+        QSet<QString>& m_seen;
+        QSet<QString> m_visited;
     };
-    
-    // 1. Parse Config
-    QFile configFile(QDir::homePath() + "/.ssh/config");
-    if (configFile.open(QIODevice::ReadOnly)) {
-        QTextStream in(&configFile);
-        QString currentHost;
-        QString currentUser;
-        QString line;
-        while (in.readLineInto(&line)) {
-            line = line.trimmed();
-            if (line.startsWith("Host ", Qt::CaseInsensitive)) {
-                // New block
-                QString hosts = line.mid(5).trimmed();
-                // "Host *" is generic, ignore
-                if (hosts == "*") continue;
-                
-                QStringList aliases = hosts.split(" ", Qt::SkipEmptyParts);
-                for (const auto& a : aliases) {
-                    addHost(a, a, ""); // User unknown yet
+
+    // Host names of known_hosts, read as bytes: the file is often the
+    // largest source by far
+    void readKnownHosts(const QString& path, SSHProvider::Hosts& hosts, QSet<QString>& seen) {
+        hosts.sources.push_back({path, mtimeOf(path)});
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) return;
+        const QByteArray data = file.readAll();
+
+        const char* p = data.constData();
+        const char* const end = p + data.size();
+        while (p < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!lineEnd) lineEnd = end;
+
+            const char* field = p;
+            while (field < lineEnd && (*field == ' ' || *field == '\t')) ++field;
+            const char* fieldEnd = field;
+            while (fieldEnd < lineEnd && *fieldEnd != ' ' && *fieldEnd != '\t') ++fieldEnd;
+            p = lineEnd + 1;
+
+            // Comments, @cert-authority / @revoked markers and hashed
+            // (|1|...) entries name no host we can list
+            if (field == fieldEnd || *field == '#' || *field == '@') continue;
+            if (fieldEnd - field >= 3 && std::memcmp(field, "|1|", 3) == 0) continue;
+
+            for (const char* name = field; name < fieldEnd;) {
+                const char* comma = static_cast<const char*>(std::memchr(name, ',', fieldEnd - name));
+                if (!comma) comma = fieldEnd;
+                const size_t length = static_cast<size_t>(comma - name);
+                // [host]:port entries and patterns are skipped
+                if (length > 0 && *name != '[' && *name != '!' &&
+                    !std::memchr(name, '*', length) && !std::memchr(name, '?', length)) {
+                    QString host = QString::fromUtf8(name, static_cast<qsizetype>(length));
+                    if (!seen.contains(host)) {
+                        seen.insert(host);
+                        hosts.knownHosts << host;
+                    }
                 }
+                name = comma + 1;
             }
         }
-        configFile.close();
     }
-    
-    // 2. Parse Known Hosts (hashed hosts are skipped)
+}
+
+std::vector<LauncherItem> SSHProvider::scan(const QString& terminalCmd, bool parseKnownHosts) {
+    Q_UNUSED(terminalCmd);
+    return toItems(load(parseKnownHosts));
+}
+
+SSHProvider::Hosts SSHProvider::load(bool parseKnownHosts) {
+    // The daemon keeps the last result; a new process starts from the cache
+    static Hosts last;
+    if (!last.sources.empty() && last.knownHostsRead == parseKnownHosts && isFresh(last)) {
+        return last;
+    }
+
+    Hosts cached = readCache();
+    if (!cached.sources.empty() && cached.knownHostsRead == parseKnownHosts && isFresh(cached)) {
+        last = std::move(cached);
+        return last;
+    }
+
+    last = parse(parseKnownHosts);
+    writeCache(last);
+    return last;
+}
+
+SSHProvider::Hosts SSHProvider::parse(bool parseKnownHosts) {
+    Hosts hosts;
+    hosts.knownHostsRead = parseKnownHosts;
+    QSet<QString> seen;
+
+    // 1. Config, with its Includes
+    ConfigReader(hosts, seen).readFile(sshDir() + "/config", 0);
+
+    // 2. Known hosts
     if (parseKnownHosts) {
-        QFile kh(QDir::homePath() + "/.ssh/known_hosts");
-        if (kh.open(QIODevice::ReadOnly)) {
-             QTextStream in(&kh);
-             QString line;
-             while(in.readLineInto(&line)) {
-                 if (line.trimmed().isEmpty()) continue;
-                 QString hostSection = line.split(" ").first();
-                 if (hostSection.startsWith("|1|")) continue; // Hashed
-                 
-                 QStringList names = hostSection.split(",");
-                 for (const auto& name : names) {
-                     if (!name.startsWith("[") && !name.contains("*")) { // clean IP or hostname
-                         addHost(name, "", "");
-                     }
-                 }
-             }
-        }
+        readKnownHosts(sshDir() + "/known_hosts", hosts, seen);
     }
-    
+    return hosts;
+}
+
+bool SSHProvider::isFresh(const Hosts& hosts) {
+    return std::all_of(hosts.sources.begin(), hosts.sources.end(), [](const Source& source) {
+        return mtimeOf(source.path) == source.mtime;
+    });
+}
+
+std::vector<LauncherItem> SSHProvider::toItems(const Hosts& hosts) {
+    std::vector<LauncherItem> items;
+    items.reserve(hosts.configHosts.size() + hosts.knownHosts.size());
+
+    auto addHost = [&items](const QString& host, bool alias) {
+        LauncherItem item;
+        item.id = "ssh:" + host;
+        item.primary = host;
+        item.secondary = alias ? "SSH -> " + host : QString("SSH Host");
+        item.iconKey = "utilities-terminal";
+
+        // LauncherController handles terminal wrapping if item.terminal is
+        // true; we just provide the raw command.
+        item.exec = "ssh " + host;
+        item.terminal = true;
+        items.push_back(std::move(item));
+    };
+
+    for (const QString& host : hosts.configHosts) addHost(host, true);
+    for (const QString& host : hosts.knownHosts) addHost(host, false);
     return items;
 }
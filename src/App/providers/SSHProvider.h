@@ -1,9 +1,44 @@
 #pragma once
 
+#include <QString>
+#include <QStringList>
 #include <vector>
 #include "../models/LauncherModel.h"
 
+/**
+ * @class SSHProvider
+ * @brief Lists SSH hosts from ~/.ssh/config and ~/.ssh/known_hosts.
+ *
+ * Include directives in the config are followed recursively, with globs
+ * expanded as ssh does and cycles cut off. The parsed host lists are kept
+ * in memory and in ssh.cache under the cache directory, together with
+ * the mtime of every file read and every directory a glob was expanded
+ * in. While none of those changed, a scan costs one stat per source.
+ */
 class SSHProvider {
 public:
+    /** @brief A file or glob directory the hosts were read from. */
+    struct Source {
+        QString path;
+        qint64 mtime = -1;          /**< Nanoseconds; -1 if the path is missing */
+    };
+
+    /** @brief Host names in list order, without duplicates. */
+    struct Hosts {
+        std::vector<Source> sources;
+        bool knownHostsRead = false;
+        QStringList configHosts;    /**< Host aliases from the config */
+        QStringList knownHosts;     /**< From known_hosts, not in configHosts */
+    };
+
     static std::vector<LauncherItem> scan(const QString& terminalCmd, bool parseKnownHosts);
+
+    /** @brief The host lists, from memory or the cache while every source is unchanged. */
+    static Hosts load(bool parseKnownHosts);
+    /** @brief Reads the config (with its Includes) and known_hosts from disk. */
+    static Hosts parse(bool parseKnownHosts);
+    /** @brief Whether every source still has the recorded mtime. */
+    static bool isFresh(const Hosts& hosts);
+    /** @brief One item per host: config aliases first, then known hosts. */
+    static std::vector<LauncherItem> toItems(const Hosts& hosts);
 };
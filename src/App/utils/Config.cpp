@@ -125,6 +125,11 @@ void Config::load(const QString& configPath)
                 set.icon = QString::fromStdString(setNode["icon"].as<std::string>());
             }
             
+            // scoring
+            if (setNode["scoring"].IsDefined()) {
+                set.scoring = QString::fromStdString(setNode["scoring"].as<std::string>());
+            }
+            
             // providers
             if (setNode["providers"].IsDefined() && setNode["providers"].IsSequence()) {
                 for (const auto& p : setNode["providers"]) {
@@ -61,6 +61,7 @@ public:
         LayoutConfig layout;
         QStringList pins;
         QMap<QString, QString> aliases;
+        QString scoring; /**< Fuzzy scorer ("greedy" or "optimal"), empty = general.scoring */
     };
     
     /** @brief Retrieves a defined ProviderSet by name. Returns empty if found. */
@@ -0,0 +1,101 @@
+#include "DirectoryWatcher.h"
+#include <QDebug>
+#include <QFile>
+#include <QSocketNotifier>
+#include <algorithm>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    constexpr uint32_t WatchMask = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                   IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+}
+
+DirectoryWatcher::DirectoryWatcher(QObject *parent)
+    : QObject(parent)
+{
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        qWarning() << "DirectoryWatcher: inotify unavailable";
+        return;
+    }
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &DirectoryWatcher::onActivated);
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+bool DirectoryWatcher::addPath(const QString& path)
+{
+    if (m_fd < 0) return false;
+
+    const int wd = inotify_add_watch(m_fd, QFile::encodeName(path).constData(), WatchMask);
+    if (wd < 0) return false;
+    // Watching the same directory again returns the same descriptor
+    m_paths.insert(wd, path);
+    return true;
+}
+
+void DirectoryWatcher::removePath(const QString& path)
+{
+    // The IN_IGNORED that follows finds no entry and is skipped
+    for (auto it = m_paths.begin(); it != m_paths.end();) {
+        if (it.value() == path) {
+            inotify_rm_watch(m_fd, it.key());
+            it = m_paths.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DirectoryWatcher::clear()
+{
+    for (auto it = m_paths.constBegin(); it != m_paths.constEnd(); ++it) {
+        inotify_rm_watch(m_fd, it.key());
+    }
+    m_paths.clear();
+}
+
+void DirectoryWatcher::onActivated()
+{
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = ::read(m_fd, buffer, sizeof(buffer))) > 0) {
+        for (const char* p = buffer; p < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                emit overflowed();
+                continue;
+            }
+            auto it = m_paths.find(event->wd);
+            if (it == m_paths.end()) continue;
+
+            if (event->mask & IN_IGNORED) {
+                // The kernel dropped the watch (directory deleted or unmounted).
+                // A directory recreated at the same path may already have a
+                // new descriptor; then the path is still watched.
+                const QString dir = it.value();
+                m_paths.erase(it);
+                if (std::find(m_paths.cbegin(), m_paths.cend(), dir) == m_paths.cend()) {
+                    emit watchRemoved(dir);
+                }
+                continue;
+            }
+            // A copy: receivers may add watches, which can rehash m_paths
+            const QString dir = it.value();
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                emit entryChanged(dir, QString(), true);
+            } else if (event->len > 0) {
+                emit entryChanged(dir, QFile::decodeName(event->name), event->mask & IN_ISDIR);
+            }
+        }
+    }
+}
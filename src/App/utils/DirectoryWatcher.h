@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+class QSocketNotifier;
+
+/**
+ * @class DirectoryWatcher
+ * @brief Reports changes to the entries of watched directories (inotify).
+ *
+ * Unlike QFileSystemWatcher, which only says that a directory changed,
+ * every event carries the name of the entry, so callers can update just
+ * that entry. Watches are not recursive; callers add subdirectories they
+ * care about themselves.
+ */
+class DirectoryWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DirectoryWatcher(QObject *parent = nullptr);
+    ~DirectoryWatcher();
+
+    /** @brief False if inotify is unavailable; addPath() then always fails. */
+    bool isValid() const { return m_fd >= 0; }
+
+    /** @brief Watches the entries of @p path. Returns false if it cannot be watched. */
+    bool addPath(const QString& path);
+    /** @brief Stops watching @p path. */
+    void removePath(const QString& path);
+    /** @brief Drops every watch. */
+    void clear();
+    int count() const { return static_cast<int>(m_paths.size()); }
+
+signals:
+    /**
+     * @brief Entry @p name of @p dir was created, written, removed, renamed
+     * or had its permissions changed. @p name is empty when @p dir itself
+     * was removed or moved away.
+     */
+    void entryChanged(const QString& dir, const QString& name, bool isDir);
+    /** @brief The kernel dropped the watch on @p dir (deleted or unmounted). */
+    void watchRemoved(const QString& dir);
+    /** @brief The kernel dropped events; everything watched must be rescanned. */
+    void overflowed();
+
+private slots:
+    void onActivated();
+
+private:
+    int m_fd = -1;
+    QSocketNotifier* m_notifier = nullptr;
+    QHash<int, QString> m_paths; /**< Watch descriptor -> directory */
+};
@@ -1,5 +1,19 @@
 #include "FuzzyMatcher.h"
 #include <QChar>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace {
+    constexpr int ExactScore = 10000;
+    constexpr int PrefixScore = 5000;
+    constexpr int NoAlignment = std::numeric_limits<int>::min() / 2;
+}
+
+FuzzyMatcher::Algorithm FuzzyMatcher::algorithmFromString(const QString& name)
+{
+    return name.compare("optimal", Qt::CaseInsensitive) == 0 ? Optimal : Greedy;
+}
 
 FuzzyMatcher::MatchResult FuzzyMatcher::match(const QString& query, const QString& target)
 {
@@ -11,38 +25,113 @@ FuzzyMatcher::MatchResult FuzzyMatcher::match(const QString& query, const QStrin
         return result;
     }
 
-    // Tier 1: Exact Match
-    if (query.compare(target, Qt::CaseInsensitive) == 0) {
-        result.matched = true;
-        result.isExact = true;
-        result.score = 10000;
-        for(int i=0; i<query.length(); ++i) result.positions.push_back(i);
-        return result;
+    // Ad-hoc matches fold the target here; the filter loop uses a SearchIndex
+    std::vector<QChar> folded(target.size());
+    std::vector<quint8> flags(target.size());
+    foldText(target, folded.data(), flags.data());
+
+    FoldedText text;
+    text.original = target.constData();
+    text.folded = folded.data();
+    text.flags = flags.data();
+    text.length = target.size();
+
+    FoldedQuery foldedQuery = foldQuery(query);
+    result.score = matchFolded(foldedQuery, text, result.positions);
+    result.matched = (result.score > 0);
+    if (result.matched && isFoldedPrefix(foldedQuery, text)) {
+        result.isExact = (query.length() == target.length());
+        result.isPrefix = !result.isExact;
     }
+    
+    return result;
+}
 
-    // Tier 2: Prefix Match
-    if (target.startsWith(query, Qt::CaseInsensitive)) {
-        result.matched = true;
-        result.isPrefix = true;
+FuzzyMatcher::FoldedQuery FuzzyMatcher::foldQuery(const QString& query)
+{
+    FoldedQuery result;
+    result.original = query;
+    result.folded.resize(query.size());
+    for (int i = 0; i < query.size(); ++i) {
+        result.folded[i] = query[i].toLower();
+    }
+    return result;
+}
+
+void FuzzyMatcher::foldText(QStringView text, QChar* folded, quint8* flags)
+{
+    for (int i = 0; i < text.size(); ++i) {
+        folded[i] = text[i].toLower();
+
+        // Tier 3: Word Boundary (Acronyms)
+        bool isWordStart = (i == 0) ||
+                           !text[i-1].isLetterOrNumber() ||
+                           (text[i].isUpper() && !text[i-1].isUpper());
+        flags[i] = isWordStart ? WordStart : 0;
+    }
+}
+
+int FuzzyMatcher::matchFolded(const FoldedQuery& query, const FoldedText& target, QVector<int>& positions)
+{
+    positions.clear();
+    return matchGreedy(query, target, &positions);
+}
+
+int FuzzyMatcher::scoreFolded(const FoldedQuery& query, const FoldedText& target)
+{
+    return matchGreedy(query, target, nullptr);
+}
+
+int FuzzyMatcher::matchOptimal(const FoldedQuery& query, const FoldedText& target, QVector<int>& positions)
+{
+    positions.clear();
+    return alignOptimal(query, target, &positions);
+}
+
+int FuzzyMatcher::scoreOptimal(const FoldedQuery& query, const FoldedText& target)
+{
+    return alignOptimal(query, target, nullptr);
+}
+
+int FuzzyMatcher::matchGreedy(const FoldedQuery& query, const FoldedText& target, QVector<int>* positions)
+{
+    const int queryLen = query.folded.length();
+    if (queryLen == 0 || queryLen > target.length) return 0;
+
+    // Tier 1 & 2: Exact / Prefix Match
+    if (isFoldedPrefix(query, target)) {
+        if (positions) {
+            for (int i = 0; i < queryLen; ++i) positions->append(i);
+        }
+        if (queryLen == target.length) {
+            return ExactScore;
+        }
         // Base 5000 + bonus for length to break ties
-        result.score = 5000 + (query.length() * 10);
-        for(int i=0; i<query.length(); ++i) result.positions.push_back(i);
-        return result;
+        return PrefixScore + (queryLen * 10);
     }
     
-    result.score = scoreMatch(query, target, result.positions);
-    result.matched = (result.score > 0);
-    
-    return result;
+    return scoreMatch(query, target, positions);
+}
+
+bool FuzzyMatcher::isFoldedPrefix(const FoldedQuery& query, const FoldedText& target)
+{
+    const int queryLen = query.folded.length();
+    if (queryLen > target.length) return false;
+
+    const QChar* lowerQuery = query.folded.constData();
+    for (int i = 0; i < queryLen; ++i) {
+        if (lowerQuery[i] != target.folded[i]) return false;
+    }
+    return true;
 }
 
-int FuzzyMatcher::scoreMatch(const QString& query, const QString& target, QVector<int>& positions)
+int FuzzyMatcher::scoreMatch(const FoldedQuery& query, const FoldedText& target, QVector<int>* positions)
 {
-    QString lowerQuery = query.toLower();
-    QString lowerTarget = target.toLower();
+    const QChar* lowerQuery = query.folded.constData();
+    const QChar* exactQuery = query.original.constData();
     
-    int queryLen = lowerQuery.length();
-    int targetLen = lowerTarget.length();
+    int queryLen = query.folded.length();
+    int targetLen = target.length;
     
     if (queryLen > targetLen) return 0;
     
@@ -52,11 +141,9 @@ int FuzzyMatcher::scoreMatch(const QString& query, const QString& target, QVecto
     int consecutiveBonus = 0;
     int lastMatchPos = -1;
     
-    positions.clear();
-    
     for (int targetIdx = 0; targetIdx < targetLen && queryIdx < queryLen; ++targetIdx) {
-        if (lowerQuery[queryIdx] == lowerTarget[targetIdx]) {
-            positions.append(targetIdx);
+        if (lowerQuery[queryIdx] == target.folded[targetIdx]) {
+            if (positions) positions->append(targetIdx);
             
             // Base score
             score += 100;
@@ -65,11 +152,7 @@ int FuzzyMatcher::scoreMatch(const QString& query, const QString& target, QVecto
             if (targetIdx == 0) score += 50;
             
             // Tier 3: Bonus for Word Boundary (Acronyms)
-            bool isWordStart = (targetIdx == 0) || 
-                               !target[targetIdx-1].isLetterOrNumber() ||
-                               (target[targetIdx].isUpper() && !target[targetIdx-1].isUpper());
-            
-            if (isWordStart) {
+            if (target.flags[targetIdx] & WordStart) {
                 score += 100; // Acronym bonus
             }
 
@@ -82,7 +165,7 @@ int FuzzyMatcher::scoreMatch(const QString& query, const QString& target, QVecto
             }
             
             // Bonus for exact case match
-            if (query[queryIdx] == target[targetIdx]) {
+            if (exactQuery[queryIdx] == target.original[targetIdx]) {
                 score += 10;
             }
             
@@ -96,9 +179,123 @@ int FuzzyMatcher::scoreMatch(const QString& query, const QString& target, QVecto
     
     // If we didn't match all query chars, no match
     if (queryIdx != queryLen) {
-        positions.clear();
+        if (positions) positions->clear();
         return 0;
     }
     
     return score;
 }
+
+int FuzzyMatcher::alignOptimal(const FoldedQuery& query, const FoldedText& target, QVector<int>* positions)
+{
+    const int m = query.folded.length();
+    const int n = target.length;
+    if (m == 0 || m > n) return 0;
+
+    // Tier 1 & 2 (exact / prefix) are the same in both algorithms
+    if (isFoldedPrefix(query, target)) return matchGreedy(query, target, positions);
+
+    // Keep the tables bounded; very long keys fall back to the greedy scan
+    if (m > OptimalMaxQuery || n > OptimalMaxTarget) return scoreMatch(query, target, positions);
+
+    // The greedy score of an alignment is a sum of per-position terms plus a
+    // bonus per run of consecutive matches, so the DP works run by run:
+    //   runEnd[i][j]   best score with query[i] matched at target[j], ending a run
+    //   prefix[i][j]   max of runEnd[i][0..j] (and its argmax)
+    // A run covering query[k..i] at target[s..j] extends the best alignment
+    // of query[0..k-1] that ends at s-2 or earlier (s-1 would join the run).
+    thread_local std::vector<int> runEnd;
+    thread_local std::vector<int> prefix;
+    thread_local std::vector<short> prefixArg;
+    thread_local std::vector<quint8> runLength; // run chosen for runEnd[i][j]
+    thread_local std::vector<quint8> diagonal;  // consecutive matches ending at (i, j)
+
+    const size_t cells = static_cast<size_t>(m) * n;
+    runEnd.resize(cells);
+    prefix.resize(cells);
+    prefixArg.resize(cells);
+    runLength.resize(cells);
+    diagonal.resize(cells);
+
+    const QChar* lowerQuery = query.folded.constData();
+    const QChar* exactQuery = query.original.constData();
+
+    // Everything greedy scoreMatch() awards a matched position, except the
+    // consecutive bonus which depends on the run
+    auto positionScore = [&](int queryIdx, int targetIdx) {
+        int score = 100;
+        if (targetIdx == 0) score += 50;
+        if (target.flags[targetIdx] & WordStart) score += 100;
+        if (exactQuery[queryIdx] == target.original[targetIdx]) score += 10;
+        return score - targetIdx;
+    };
+
+    for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < n; ++j) {
+            const size_t cell = static_cast<size_t>(i) * n + j;
+            int best = NoAlignment;
+            int bestRun = 0;
+
+            if (lowerQuery[i] == target.folded[j]) {
+                diagonal[cell] = (i > 0 && j > 0) ? diagonal[cell - n - 1] + 1 : 1;
+
+                int runScore = 0;
+                for (int length = 1; length <= diagonal[cell]; ++length) {
+                    const int first = i - length + 1;      // first query char of the run
+                    const int start = j - length + 1;      // where it matched
+                    runScore += positionScore(first, start);
+
+                    int before = 0;
+                    if (first > 0) {
+                        if (start < 2) continue;
+                        before = prefix[static_cast<size_t>(first - 1) * n + (start - 2)];
+                        if (before == NoAlignment) continue;
+                    }
+
+                    // Consecutive bonus: +20, +40, ... along the run. Like the
+                    // greedy scan, a run at index 0 continues a virtual match at -1.
+                    const int bonus = (start == 0) ? 10 * length * (length + 1)
+                                                   : 10 * length * (length - 1);
+                    const int total = before + runScore + bonus;
+                    if (total > best) {
+                        best = total;
+                        bestRun = length;
+                    }
+                }
+            } else {
+                diagonal[cell] = 0;
+            }
+
+            runEnd[cell] = best;
+            runLength[cell] = static_cast<quint8>(bestRun);
+            if (j == 0 || best > prefix[cell - 1]) {
+                prefix[cell] = best;
+                prefixArg[cell] = static_cast<short>(j);
+            } else {
+                prefix[cell] = prefix[cell - 1];
+                prefixArg[cell] = prefixArg[cell - 1];
+            }
+        }
+    }
+
+    const size_t last = static_cast<size_t>(m - 1) * n + (n - 1);
+    if (prefix[last] == NoAlignment) return 0;
+    if (!positions) return prefix[last];
+
+    // Walk the chosen runs back to front
+    positions->resize(m);
+    int i = m - 1;
+    int j = prefixArg[last];
+    while (true) {
+        const int length = runLength[static_cast<size_t>(i) * n + j];
+        for (int k = 0; k < length; ++k) {
+            (*positions)[i - k] = j - k;
+        }
+        i -= length;
+        j -= length;
+        if (i < 0) break;
+        j = prefixArg[static_cast<size_t>(i) * n + (j - 1)];
+    }
+
+    return prefix[last];
+}
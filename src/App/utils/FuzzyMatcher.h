@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QString>
+#include <QStringView>
 #include <QVector>
 
 /**
@@ -13,6 +14,10 @@
  * - Consecutive character bonus (+20 per char)
  * - Exact case bonus (+10)
  * - Late match penalty (-1 per target index)
+ *
+ * Two algorithms maximize this score: the greedy scan takes the first
+ * occurrence of each query character, the optimal one searches every
+ * alignment (so a later word-boundary match can win) at DP cost.
  */
 class FuzzyMatcher
 {
@@ -26,9 +31,85 @@ public:
         bool isPrefix = false;  /**< True if prefix match */
     };
 
+    /** @brief Scoring algorithm, selectable per provider set ("scoring"). */
+    enum Algorithm {
+        Greedy,  /**< First occurrence of each char, O(n) */
+        Optimal  /**< Best-scoring alignment, O(m*n) with bounded tables */
+    };
+
+    /** @brief Longest query / target the optimal scorer handles (greedy beyond). */
+    static constexpr int OptimalMaxQuery = 32;
+    static constexpr int OptimalMaxTarget = 256;
+
+    /** @brief Parses a config value ("greedy", "optimal"); unknown -> Greedy. */
+    static Algorithm algorithmFromString(const QString& name);
+
+    /** @brief Per-character flags precomputed alongside folded text. */
+    enum CharFlag : quint8 {
+        WordStart = 0x1 /**< First char, after a separator, or a lower->Upper step */
+    };
+
+    /**
+     * @brief A target string with case folding and word boundaries precomputed.
+     *
+     * The buffers are owned by the caller (see SearchIndex); all three hold
+     * exactly @c length entries.
+     */
+    struct FoldedText {
+        const QChar* original = nullptr; /**< Text as displayed (exact case bonus) */
+        const QChar* folded = nullptr;   /**< Lower-cased text, index-aligned with original */
+        const quint8* flags = nullptr;   /**< CharFlag bits per character */
+        int length = 0;
+    };
+
+    /** @brief A query folded once per keystroke instead of once per target. */
+    struct FoldedQuery {
+        QString original;
+        QString folded;
+    };
+
     /** @brief Executes a fuzzy match of @p query against @p target. */
     static MatchResult match(const QString& query, const QString& target);
+
+    /** @brief Folds @p query for use with matchFolded(). */
+    static FoldedQuery foldQuery(const QString& query);
+
+    /**
+     * @brief Writes the folded characters and CharFlag bits of @p text.
+     *
+     * Both @p folded and @p flags must have room for @c text.size() entries.
+     */
+    static void foldText(QStringView text, QChar* folded, quint8* flags);
+
+    /**
+     * @brief Scores a pre-folded query against pre-folded text.
+     *
+     * Same tiers and scores as match(), without allocating or case
+     * converting. @p positions is cleared and refilled, so a caller reusing
+     * one vector keeps its capacity. Returns 0 when there is no match.
+     */
+    static int matchFolded(const FoldedQuery& query, const FoldedText& target, QVector<int>& positions);
+
+    /**
+     * @brief Like matchFolded(), but returns the best alignment's score.
+     *
+     * Never scores below matchFolded() for the same input. DP tables are
+     * per thread and bounded by OptimalMaxQuery x OptimalMaxTarget.
+     */
+    static int matchOptimal(const FoldedQuery& query, const FoldedText& target, QVector<int>& positions);
+
+    /**
+     * @brief Score-only variants of matchFolded() / matchOptimal().
+     *
+     * Same scores, but no positions are recorded. Used to rank; positions
+     * are only worked out for the rows that are actually shown.
+     */
+    static int scoreFolded(const FoldedQuery& query, const FoldedText& target);
+    static int scoreOptimal(const FoldedQuery& query, const FoldedText& target);
     
 private:
-    static int scoreMatch(const QString& query, const QString& target, QVector<int>& positions);
+    static bool isFoldedPrefix(const FoldedQuery& query, const FoldedText& target);
+    static int matchGreedy(const FoldedQuery& query, const FoldedText& target, QVector<int>* positions);
+    static int alignOptimal(const FoldedQuery& query, const FoldedText& target, QVector<int>* positions);
+    static int scoreMatch(const FoldedQuery& query, const FoldedText& target, QVector<int>* positions);
 };
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QStringView>
+
+/**
+ * @brief Stable 64-bit hash of an item id (FNV-1a over UTF-16 code units).
+ *
+ * Persisted in the history file, so unlike qHash() it must not depend on
+ * the process seed or the Qt version.
+ */
+inline quint64 idHash(QStringView id)
+{
+    quint64 hash = 14695981039346656037ULL;
+    for (QChar c : id) {
+        hash ^= c.unicode();
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -1,12 +1,77 @@
 #include "MRUTracker.h"
+#include "IdHash.h"
 #include <QStandardPaths>
 #include <QDir>
-#include <QFile>
+#include <QLockFile>
+#include <QSaveFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDateTime>
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+    // How long the writer waits for another instance to release the history
+    constexpr int LockTimeoutMs = 2000;
+
+    constexpr double HalfLifeMs = MRUTracker::HalfLifeDays * 86400000.0;
+    // Boost of one fresh activation, and the most any item gets
+    constexpr int BoostPerUse = 200;
+    constexpr int MaxBoost = 1000;
+    // Decay makes boosts drift slowly; callers may reuse them this long
+    constexpr qint64 BoostRefreshMs = 5 * 60 * 1000;
+    // Journal times further ahead than this are garbage: they would never decay
+    constexpr qint64 MaxClockSkewMs = 24 * 60 * 60 * 1000;
+
+    // On-disk layout, native byte order (the cache never leaves the machine)
+    constexpr char SnapshotMagic[4] = {'A', 'W', 'E', 'H'};
+    constexpr quint32 SnapshotVersion = 1;
+
+    struct SnapshotHeader {
+        char magic[4];
+        quint32 version;
+        quint32 count;
+        quint32 reserved;
+    };
+
+    struct SnapshotRecord {
+        quint64 hash;       // Records are sorted by hash
+        qint64 lastUsed;
+        double score;
+        quint32 count;
+        quint32 reserved;
+    };
+
+    struct JournalRecord {
+        quint64 hash;
+        qint64 when;
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 16);
+    static_assert(sizeof(SnapshotRecord) == 32);
+    static_assert(sizeof(JournalRecord) == 16);
+
+    // Records of a snapshot image, or nullptr if it is not a valid one
+    const SnapshotRecord* snapshotRecords(const uchar* data, qint64 size, quint32& count)
+    {
+        if (!data || size < static_cast<qint64>(sizeof(SnapshotHeader))) return nullptr;
+
+        SnapshotHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0 ||
+            header.version != SnapshotVersion ||
+            size != static_cast<qint64>(sizeof(SnapshotHeader) + header.count * sizeof(SnapshotRecord))) {
+            return nullptr;
+        }
+        count = header.count;
+        return reinterpret_cast<const SnapshotRecord*>(data + sizeof(SnapshotHeader));
+    }
+}
 
 MRUTracker& MRUTracker::instance()
 {
@@ -17,130 +82,354 @@ MRUTracker& MRUTracker::instance()
 MRUTracker::MRUTracker(QObject *parent)
     : QObject(parent)
 {
+    m_writer.setMaxThreadCount(1);
     load();
 }
 
+MRUTracker::~MRUTracker()
+{
+    // Let queued appends reach the journal before exit
+    m_writer.waitForDone();
+    if (!m_unwritten.empty() && !flushJournal()) {
+        qWarning() << "[MRU] History is locked, dropping" << m_unwritten.size() << "activations";
+    }
+}
+
 void MRUTracker::recordActivation(const QString& itemId)
 {
     qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const quint64 hash = idHash(itemId);
     
     // Create or update entry
-    HistoryEntry& entry = m_history[itemId];
-    entry.id = itemId;
-    entry.lastUsed = now;
-    entry.count++;
+    {
+        QWriteLocker locker(&m_lock);
+        auto it = m_recent.find(hash);
+        if (it == m_recent.end()) {
+            Entry base;
+            lookupSnapshot(hash, base);
+            it = m_recent.insert(hash, base);
+        }
+        apply(*it, now);
+    }
+    m_version.fetch_add(1, std::memory_order_relaxed);
     
-    save();
+    // Persisting happens off the launch path
+    m_writer.start([this, hash, now]() {
+        appendToJournal(hash, now);
+    });
 }
 
-int MRUTracker::getBoost(const QString& itemId) const
+QHash<quint64, int> MRUTracker::boosts(qint64 now, qint64* validUntil) const
 {
-    if (!m_history.contains(itemId)) {
-        return 0;
+    QReadLocker locker(&m_lock);
+    QHash<quint64, int> result;
+    result.reserve(m_recent.size() + m_snapshotCount);
+
+    auto add = [&result, now](quint64 hash, const Entry& entry) {
+        const int boost = boostOf(entry, now);
+        if (boost > 0) result.insert(hash, boost);
+    };
+    for (auto it = m_recent.constBegin(); it != m_recent.constEnd(); ++it) {
+        add(it.key(), it.value());
     }
-    
-    const HistoryEntry& entry = m_history[itemId];
-    qint64 now = QDateTime::currentMSecsSinceEpoch();
-    qint64 ageMs = now - entry.lastUsed;
-    
-    int score = 0;
-    
-    // 1. Recency Boost
-    if (ageMs < 3600000) {  // < 1 hour
-        score += 500;
-    } else if (ageMs < 86400000) {  // < 1 day
-        score += 200;
-    } else if (ageMs < 604800000) {  // < 1 week
-        score += 50;
+
+    const auto* records = reinterpret_cast<const SnapshotRecord*>(m_snapshot);
+    for (quint32 i = 0; i < m_snapshotCount; ++i) {
+        const SnapshotRecord& record = records[i];
+        if (m_recent.contains(record.hash)) continue;
+        add(record.hash, {record.score, record.lastUsed, record.count});
     }
-    
-    // 2. Frequency Boost (cap at 500)
-    int freqBoost = std::min(entry.count * 10, 500);
-    score += freqBoost;
-    
-    return score;
+
+    if (validUntil) {
+        *validUntil = result.isEmpty() ? std::numeric_limits<qint64>::max() : now + BoostRefreshMs;
+    }
+    return result;
+}
+
+double MRUTracker::decayed(const Entry& entry, qint64 now)
+{
+    if (now <= entry.lastUsed) return entry.score;
+    return entry.score * std::exp2(-(now - entry.lastUsed) / HalfLifeMs);
+}
+
+void MRUTracker::apply(Entry& entry, qint64 when)
+{
+    if (when >= entry.lastUsed) {
+        entry.score = decayed(entry, when) + 1.0;
+        entry.lastUsed = when;
+    } else {
+        // Journal of another instance, replayed out of order
+        entry.score += std::exp2(-(entry.lastUsed - when) / HalfLifeMs);
+    }
+    entry.count++;
+}
+
+int MRUTracker::boostOf(const Entry& entry, qint64 now)
+{
+    return std::min(MaxBoost, static_cast<int>(std::lround(decayed(entry, now) * BoostPerUse)));
+}
+
+bool MRUTracker::lookupSnapshot(quint64 hash, Entry& entry) const
+{
+    const auto* records = reinterpret_cast<const SnapshotRecord*>(m_snapshot);
+    const SnapshotRecord* end = records + m_snapshotCount;
+    const SnapshotRecord* it = std::lower_bound(records, end, hash, [](const SnapshotRecord& record, quint64 value) {
+        return record.hash < value;
+    });
+    if (it == end || it->hash != hash) return false;
+
+    entry.score = it->score;
+    entry.lastUsed = it->lastUsed;
+    entry.count = it->count;
+    return true;
+}
+
+QString MRUTracker::historyDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/awelauncher";
 }
 
 void MRUTracker::load()
 {
-    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
-    QString historyPath = cacheDir + "/awelauncher/history.json";
-    
-    // Migration: Check for old mru.json if history.json doesn't exist
-    if (!QFile::exists(historyPath)) {
-        QString oldMruPath = cacheDir + "/awelauncher/mru.json";
-        if (QFile::exists(oldMruPath)) {
-            qInfo() << "[MRU] Migrating from mru.json to history.json";
-            QFile oldFile(oldMruPath);
-            if (oldFile.open(QIODevice::ReadOnly)) {
-                 QJsonDocument doc = QJsonDocument::fromJson(oldFile.readAll());
-                 if (doc.isObject()) {
-                     QJsonObject obj = doc.object();
-                     for (auto it = obj.begin(); it != obj.end(); ++it) {
-                         HistoryEntry e;
-                         e.id = it.key();
-                         e.lastUsed = it.value().toVariant().toLongLong();
-                         e.count = 1; // Start with count 1
-                         m_history[e.id] = e;
-                     }
-                 }
-                 oldFile.close();
+    const QString dir = historyDir();
+    const QString snapshotPath = dir + "/history.bin";
+
+    // Migration: history.json / mru.json from before the binary format
+    if (!QFile::exists(snapshotPath)) {
+        History legacy;
+        if (importLegacy(dir, legacy)) {
+            qInfo() << "[MRU] Migrating history.json to history.bin";
+            QDir().mkpath(dir);
+            QLockFile lock(dir + "/history.lock");
+            if (lock.tryLock(LockTimeoutMs)) {
+                writeSnapshot(snapshotPath, legacy);
             }
-            save(); // Save immediately in new format
-            return;
         }
     }
-    
-    QFile file(historyPath);
+
+    m_snapshotFile.setFileName(snapshotPath);
+    if (m_snapshotFile.open(QIODevice::ReadOnly) && m_snapshotFile.size() > 0) {
+        const uchar* data = m_snapshotFile.map(0, m_snapshotFile.size());
+        if (snapshotRecords(data, m_snapshotFile.size(), m_snapshotCount)) {
+            m_snapshot = data + sizeof(SnapshotHeader);
+        } else {
+            qWarning() << "[MRU] Ignoring invalid history file" << snapshotPath;
+            m_snapshotCount = 0;
+        }
+    }
+
+    m_journalEntries = replayJournal(dir + "/history.log", m_recent, this);
+}
+
+bool MRUTracker::readSnapshot(const QString& path, History& history)
+{
+    QFile file(path);
     if (!file.open(QIODevice::ReadOnly)) {
-        return;
+        return false;
     }
-    
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    file.close();
-    
-    if (doc.isObject() && doc.object()["history"].isArray()) {
-        QJsonArray arr = doc.object()["history"].toArray();
-        for (const auto& val : arr) {
-            QJsonObject item = val.toObject();
-            HistoryEntry e;
-            e.id = item["id"].toString();
-            e.count = item["count"].toInt();
-            e.lastUsed = static_cast<qint64>(item["last"].toDouble());
-            m_history[e.id] = e;
+    const QByteArray data = file.readAll();
+
+    quint32 count = 0;
+    const SnapshotRecord* records = snapshotRecords(reinterpret_cast<const uchar*>(data.constData()),
+                                                    data.size(), count);
+    if (!records) return false;
+
+    history.reserve(history.size() + count);
+    for (quint32 i = 0; i < count; ++i) {
+        history.insert(records[i].hash, {records[i].score, records[i].lastUsed, records[i].count});
+    }
+    return true;
+}
+
+int MRUTracker::replayJournal(const QString& path, History& history, const MRUTracker* base)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    // A torn last record (crash mid-append) is shorter than a record and ignored
+    const QByteArray data = file.readAll();
+    const int entries = data.size() / static_cast<int>(sizeof(JournalRecord));
+    const qint64 latest = QDateTime::currentMSecsSinceEpoch() + MaxClockSkewMs;
+    for (int i = 0; i < entries; ++i) {
+        JournalRecord record;
+        std::memcpy(&record, data.constData() + i * sizeof(JournalRecord), sizeof(record));
+        if (record.when > latest || record.when <= 0) continue;
+
+        auto it = history.find(record.hash);
+        if (it == history.end()) {
+            Entry entry;
+            if (base) base->lookupSnapshot(record.hash, entry);
+            it = history.insert(record.hash, entry);
         }
+        apply(*it, record.when);
     }
+    return entries;
 }
 
-void MRUTracker::save()
+bool MRUTracker::writeSnapshot(const QString& path, const History& history)
 {
-    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
-    QString cachePath = cacheDir + "/awelauncher";
-    QDir dir;
-    dir.mkpath(cachePath);
-    
-    QString historyPath = cachePath + "/history.json";
-    
-    QJsonArray arr;
-    for (auto it = m_history.begin(); it != m_history.end(); ++it) {
-        QJsonObject item;
-        item["id"] = it.value().id;
-        item["count"] = it.value().count;
-        item["last"] = static_cast<double>(it.value().lastUsed);
-        arr.append(item);
+    std::vector<SnapshotRecord> records;
+    records.reserve(history.size());
+    for (auto it = history.constBegin(); it != history.constEnd(); ++it) {
+        records.push_back({it.key(), it.value().lastUsed, it.value().score, it.value().count, 0});
     }
-    
-    QJsonObject root;
-    root["history"] = arr;
-    
-    QJsonDocument doc(root);
-    
-    QFile file(historyPath);
+    std::sort(records.begin(), records.end(), [](const SnapshotRecord& a, const SnapshotRecord& b) {
+        return a.hash < b.hash;
+    });
+
+    SnapshotHeader header;
+    std::memcpy(header.magic, SnapshotMagic, sizeof(SnapshotMagic));
+    header.version = SnapshotVersion;
+    header.count = static_cast<quint32>(records.size());
+    header.reserved = 0;
+
+    // QSaveFile writes a temporary file and renames it over the old one,
+    // so readers (and our own mapping) never see a partial snapshot
+    QSaveFile file(path);
     if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Failed to save history data to" << historyPath;
-        return;
+        qWarning() << "Failed to save history data to" << path;
+        return false;
     }
-    
-    file.write(doc.toJson());
-    file.close();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()),
+               static_cast<qint64>(records.size() * sizeof(SnapshotRecord)));
+    return file.commit();
+}
+
+bool MRUTracker::importLegacy(const QString& dir, History& history)
+{
+    auto add = [&history](const QString& id, int count, qint64 lastUsed) {
+        if (id.isEmpty()) return;
+        Entry& entry = history[idHash(id)];
+        entry.lastUsed = std::max(entry.lastUsed, lastUsed);
+        entry.count += count;
+        // Only the total is known; count it as one burst of at most 10 uses
+        entry.score = std::min<double>(entry.count, 10.0);
+    };
+
+    bool found = false;
+    QFile historyFile(dir + "/history.json");
+    QFile mruFile(dir + "/mru.json");
+    if (historyFile.open(QIODevice::ReadOnly)) {
+        found = true;
+        QJsonDocument doc = QJsonDocument::fromJson(historyFile.readAll());
+        if (doc.isObject() && doc.object()["history"].isArray()) {
+            QJsonArray arr = doc.object()["history"].toArray();
+            for (const auto& val : arr) {
+                QJsonObject item = val.toObject();
+                add(item["id"].toString(), item["count"].toInt(),
+                    static_cast<qint64>(item["last"].toDouble()));
+            }
+        }
+    } else if (mruFile.open(QIODevice::ReadOnly)) {
+        found = true;
+        QJsonDocument doc = QJsonDocument::fromJson(mruFile.readAll());
+        if (doc.isObject()) {
+            QJsonObject obj = doc.object();
+            for (auto it = obj.begin(); it != obj.end(); ++it) {
+                add(it.key(), 1, it.value().toVariant().toLongLong());
+            }
+        }
+    }
+
+    // Activations journaled as JSON lines since the last history.json
+    QFile journal(dir + "/history.journal");
+    if (journal.open(QIODevice::ReadOnly)) {
+        found = true;
+        while (!journal.atEnd()) {
+            const QJsonObject line = QJsonDocument::fromJson(journal.readLine()).object();
+            add(line["id"].toString(), 1, static_cast<qint64>(line["t"].toDouble()));
+        }
+    }
+    return found;
+}
+
+void MRUTracker::appendToJournal(quint64 hash, qint64 when)
+{
+    // Queued first: if the lock is held, the activation waits for the next
+    // append instead of being lost
+    m_unwritten.emplace_back(hash, when);
+    flushJournal();
+}
+
+bool MRUTracker::flushJournal()
+{
+    const QString dir = historyDir();
+    QDir().mkpath(dir);
+
+    // Appends need the lock too: compact() replays and then empties the
+    // journal, and an append in between would be lost
+    QLockFile lock(dir + "/history.lock");
+    if (!lock.tryLock(LockTimeoutMs)) {
+        qWarning() << "[MRU] History is locked, keeping" << m_unwritten.size() << "activations for later";
+        return false;
+    }
+
+    QFile journal(dir + "/history.log");
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Failed to append history data to" << journal.fileName();
+        return false;
+    }
+    // Drop a torn record first, or every record after it would be read
+    // shifted into garbage
+    const qint64 size = journal.size();
+    if (size % static_cast<qint64>(sizeof(JournalRecord)) != 0) {
+        qWarning() << "[MRU] Truncating a torn record off" << journal.fileName();
+        journal.resize(size - size % static_cast<qint64>(sizeof(JournalRecord)));
+    }
+    std::vector<JournalRecord> records;
+    records.reserve(m_unwritten.size());
+    for (const auto& [hash, when] : m_unwritten) records.push_back({hash, when});
+    const qint64 bytes = static_cast<qint64>(records.size() * sizeof(JournalRecord));
+    if (journal.write(reinterpret_cast<const char*>(records.data()), bytes) != bytes || !journal.flush()) {
+        // Whole records only, so a retry does not shift the ones after it
+        qWarning() << "Failed to append history data to" << journal.fileName();
+        journal.resize(size - size % static_cast<qint64>(sizeof(JournalRecord)));
+        return false;
+    }
+    journal.close();
+
+    m_journalEntries += static_cast<int>(m_unwritten.size());
+    m_unwritten.clear();
+    if (m_journalEntries >= CompactThreshold) {
+        compact();
+    }
+    return true;
+}
+
+void MRUTracker::compact()
+{
+    // Called with the lock held. Merge what is on disk rather than our own
+    // state, so activations recorded by other instances are kept.
+    const QString dir = historyDir();
+    History merged;
+    readSnapshot(dir + "/history.bin", merged);
+    replayJournal(dir + "/history.log", merged);
+
+    // Evict what has decayed away, then cap the size
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = merged.begin(); it != merged.end();) {
+        if (decayed(it.value(), now) < EvictBelow) it = merged.erase(it);
+        else ++it;
+    }
+    if (merged.size() > MaxEntries) {
+        std::vector<double> scores;
+        scores.reserve(merged.size());
+        for (const Entry& entry : merged) scores.push_back(decayed(entry, now));
+        std::nth_element(scores.begin(), scores.begin() + (scores.size() - MaxEntries), scores.end());
+        const double cutoff = scores[scores.size() - MaxEntries];
+        for (auto it = merged.begin(); it != merged.end();) {
+            if (decayed(it.value(), now) < cutoff) it = merged.erase(it);
+            else ++it;
+        }
+    }
+
+    if (!writeSnapshot(dir + "/history.bin", merged)) return;
+
+    // A crash right here replays the journal onto a snapshot that already
+    // contains it; scores only ever come out slightly high.
+    QFile::resize(dir + "/history.log", 0);
+    m_journalEntries = 0;
 }
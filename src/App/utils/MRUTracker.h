@@ -1,9 +1,36 @@
 #pragma once
 
 #include <QObject>
-#include <QMap>
+#include <QFile>
+#include <QHash>
+#include <QReadWriteLock>
 #include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <utility>
+#include <vector>
 
+/**
+ * @class MRUTracker
+ * @brief Activation history used to boost frequently and recently used items.
+ *
+ * Each item id is stored as a 64-bit hash (see idHash()) with a frecency
+ * score: every activation adds 1, and the total halves every HalfLifeDays.
+ *
+ * History lives in two binary files under the cache directory:
+ * - history.bin: a snapshot of fixed-size records sorted by hash. It is
+ *   memory-mapped at startup and searched in place, so startup cost does
+ *   not grow with history size.
+ * - history.log: an append-only journal with one record per activation.
+ *
+ * Activations are appended from a background writer, so launching never
+ * waits on disk. Once the journal is long enough, the writer folds it into
+ * a new snapshot and evicts entries whose score has decayed below
+ * EvictBelow. Both steps run under a lock file, so a daemon and a
+ * standalone instance never overwrite each other's history. Activations
+ * that find the lock held are kept and written with the next append, or
+ * on exit.
+ */
 class MRUTracker : public QObject
 {
     Q_OBJECT
@@ -11,19 +38,78 @@ public:
     static MRUTracker& instance();
     
     void recordActivation(const QString& itemId);
-    int getBoost(const QString& itemId) const;
+
+    /**
+     * @brief Boost of every item in the history, keyed by idHash().
+     *
+     * Scores decay continuously; @p validUntil receives the time (ms since
+     * epoch) until which the result may be reused, unless version() changes.
+     */
+    QHash<quint64, int> boosts(qint64 now, qint64* validUntil) const;
+
+    /** @brief Incremented on every history change. */
+    quint64 version() const { return m_version.load(std::memory_order_relaxed); }
+
+    /** @brief Days after which an activation counts half. */
+    static constexpr double HalfLifeDays = 7.0;
+    /** @brief Entries scoring below this are evicted on compaction. */
+    static constexpr double EvictBelow = 0.05;
+    /** @brief Upper bound on stored entries; the lowest scores go first. */
+    static constexpr int MaxEntries = 20000;
     
 private:
+    friend class TestMRUTracker; // Builds trackers over a scratch cache directory
+
     explicit MRUTracker(QObject *parent = nullptr);
-    
-    void load();
-    void save();
-    
-    struct HistoryEntry {
-        QString id;
-        int count = 0;
+    ~MRUTracker();
+
+    struct Entry {
+        double score = 0;     /**< Frecency as of lastUsed */
         qint64 lastUsed = 0;
+        quint32 count = 0;
     };
+    using History = QHash<quint64, Entry>;
+
+    /** @brief Journal entries after which the writer compacts. */
+    static constexpr int CompactThreshold = 256;
+
+    static double decayed(const Entry& entry, qint64 now);
+    static void apply(Entry& entry, qint64 when);
+    static int boostOf(const Entry& entry, qint64 now);
+
+    void load();
+    /** @brief Entry of @p hash in the mapped snapshot. */
+    bool lookupSnapshot(quint64 hash, Entry& entry) const;
+
+    static QString historyDir();
+    static bool readSnapshot(const QString& path, History& history);
+    /**
+     * @brief Applies the journal at @p path to @p history; returns its entry count.
+     *
+     * Ids not in @p history yet start from their entry in @p base's
+     * snapshot, if a tracker is given.
+     */
+    static int replayJournal(const QString& path, History& history, const MRUTracker* base = nullptr);
+    static bool writeSnapshot(const QString& path, const History& history);
+    /** @brief One-time import of the old JSON history files. */
+    static bool importLegacy(const QString& dir, History& history);
+
+    // Writer thread only (and the destructor, once the writer is done)
+    void appendToJournal(quint64 hash, qint64 when);
+    /** @brief Writes m_unwritten to the journal; false if it is kept for later. */
+    bool flushJournal();
+    void compact();
+
+    // Snapshot mapped at startup; never modified while mapped
+    QFile m_snapshotFile;
+    const uchar* m_snapshot = nullptr;
+    quint32 m_snapshotCount = 0;
 
-    QMap<QString, HistoryEntry> m_history; 
+    History m_recent;              /**< Entries changed since the snapshot was written */
+    mutable QReadWriteLock m_lock; /**< Guards m_recent */
+    std::atomic<quint64> m_version{0};
+    QThreadPool m_writer;          /**< One thread; appends stay in order */
+    int m_journalEntries = 0;      /**< Writer thread only once load() is done */
+    /** @brief Activations not journaled yet (the lock was held), oldest first. */
+    std::vector<std::pair<quint64, qint64>> m_unwritten;
 };
@@ -35,6 +35,10 @@
 #include "App/utils/Theme.h"
 #include "App/providers/IconProvider.h"
 #include "App/providers/DesktopFileLoader.h"
+#include "App/providers/DesktopIndex.h"
+#include "App/providers/PathIndex.h"
+#include "App/providers/ProcessMonitor.h"
+#include "App/providers/ProcessTable.h"
 #include "App/providers/WindowProvider.h"
 #include "App/providers/StdinProvider.h"
 #include "App/providers/PathProvider.h"
@@ -284,6 +288,31 @@ int main(int argc, char *argv[])
     // Connect logic
     controller->setModel(model);
 
+    // Daemon: keep the application and PATH lists resident, updated through
+    // inotify, track processes through the proc connector where permitted
+    // and sample CPU usage for top in the background
+    if (startDaemon) {
+        auto *desktopIndex = new DesktopIndex(&app);
+        desktopIndex->start();
+        controller->setDesktopIndex(desktopIndex);
+
+        auto *pathIndex = new PathIndex(&app);
+        pathIndex->start();
+        controller->setPathIndex(pathIndex);
+
+        auto *processTable = new ProcessTable(&app);
+        processTable->start();
+        controller->setProcessTable(processTable);
+
+        auto *processMonitor = new ProcessMonitor(&app);
+        processMonitor->setProcessTable(processTable);
+        processMonitor->start();
+        controller->setProcessMonitor(processMonitor);
+        // An idle daemon does not sample
+        QObject::connect(controller, &LauncherController::windowVisibleChanged,
+                         processMonitor, &ProcessMonitor::setActive);
+    }
+
     // Initialize WindowProvider if possible
     // Initialize WindowProvider if possible
     WindowProvider* wp = new WindowProvider(&app);
@@ -305,7 +334,7 @@ int main(int argc, char *argv[])
         QObject::connect(stdinProvider, &StdinProvider::itemsChanged, model, [model, stdinProvider](){
             auto items = stdinProvider->getItems();
             std::vector<LauncherItem> stdItems(items.begin(), items.end());
-            model->setItems(stdItems);
+            model->setItems(std::move(stdItems));
         });
         stdinProvider->start();
         controller->setDmenuMode(true);
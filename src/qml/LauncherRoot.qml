@@ -184,6 +184,13 @@ Window {
                     }
                     highlightMoveDuration: 100
                     spacing: AppTheme.padding / 4
+
+                    // Rows are diffed rather than reset, so the current row
+                    // would follow its item; a new result set starts at the top.
+                    Connections {
+                        target: LauncherModel
+                        function onResultsChanged() { resultsList.currentIndex = 0 }
+                    }
                 }
                 
                 // Empty State Overlay
@@ -0,0 +1,296 @@
+// Keystroke latency benchmark for LauncherModel::filter().
+//
+// Generates synthetic item sets, types realistic queries into the model one
+// character at a time (including typos and backspace) and prints one JSON
+// object per corpus with per-keystroke latency percentiles and heap
+// allocation counts:
+//
+//   bench_filter [--corpus desktop|path|dmenu|all] [--rounds N]
+//
+// Allocations are counted by interposing malloc, which glibc allows; on
+// other C libraries the alloc fields are null.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include "App/models/LauncherModel.h"
+
+namespace {
+    std::atomic<quint64> g_allocations{0};
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+    __libc_free(ptr);
+}
+}
+constexpr bool CountsAllocations = true;
+#else
+constexpr bool CountsAllocations = false;
+#endif
+
+namespace {
+
+const QStringList Words = {
+    "firefox", "terminal", "editor", "text", "file", "manager", "image", "viewer",
+    "settings", "system", "monitor", "network", "sound", "video", "player", "office",
+    "writer", "calc", "impress", "mail", "chat", "browser", "music", "photo",
+    "document", "archive", "disk", "usage", "calendar", "clock", "weather", "maps",
+    "code", "studio", "git", "python", "shell", "power", "backup", "screen",
+    "capture", "print", "scan", "font", "color", "picker", "notes", "tasks"
+};
+
+const QStringList Categories = {
+    "Utility;", "Development;IDE;", "Graphics;Viewer;", "AudioVideo;Player;",
+    "Network;WebBrowser;", "Office;WordProcessor;", "System;Monitor;", "Settings;"
+};
+
+QString pick(std::mt19937& rng, const QStringList& list)
+{
+    return list[std::uniform_int_distribution<int>(0, list.size() - 1)(rng)];
+}
+
+QString capitalized(const QString& word)
+{
+    return word.left(1).toUpper() + word.mid(1);
+}
+
+// Desktop entries: short names, comments, keywords and categories
+std::vector<LauncherItem> desktopCorpus(int count, std::mt19937& rng)
+{
+    std::vector<LauncherItem> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        LauncherItem item;
+        const QString a = pick(rng, Words);
+        const QString b = pick(rng, Words);
+        item.id = QString("org.example.%1%2%3.desktop").arg(capitalized(a), capitalized(b)).arg(i);
+        item.primary = capitalized(a) + " " + capitalized(b);
+        item.secondary = QString("%1 for your %2").arg(capitalized(b), pick(rng, Words));
+        item.exec = a + "-" + b + " %U";
+        item.iconKey = i % 4 ? "application-x-executable" : a;
+        item.keywords = pick(rng, Words) + ";" + pick(rng, Words) + ";";
+        item.categories = pick(rng, Categories);
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+// PATH binaries: dashed names with versions, full path as secondary text
+std::vector<LauncherItem> pathCorpus(int count, std::mt19937& rng)
+{
+    static const QStringList Dirs = {"/usr/bin", "/usr/local/bin", "/usr/sbin", "/opt/tools/bin"};
+    std::vector<LauncherItem> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        LauncherItem item;
+        QString name = pick(rng, Words) + "-" + pick(rng, Words);
+        if (i % 3 == 0) name += QString("-%1").arg(i % 17);
+        name += QString::number(i);
+        item.primary = name;
+        item.secondary = pick(rng, Dirs) + "/" + name;
+        item.id = item.secondary;
+        item.exec = item.secondary;
+        item.iconKey = "application-x-executable";
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+// dmenu lines: long file paths
+std::vector<LauncherItem> dmenuCorpus(int count, std::mt19937& rng)
+{
+    std::vector<LauncherItem> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        LauncherItem item;
+        item.primary = QString("/home/user/%1/%2/%3_%4.txt")
+                           .arg(pick(rng, Words), pick(rng, Words), pick(rng, Words))
+                           .arg(i);
+        item.id = item.primary;
+        item.exec = item.primary;
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+// Queries as the model sees them while someone types @p target, makes a
+// typo, corrects it and finally clears the field again.
+QStringList typingSequence(const QString& target, QChar typo)
+{
+    QStringList queries;
+    QString text;
+    for (int i = 0; i < target.size(); ++i) {
+        text += target[i];
+        queries << text;
+        if (i == target.size() / 2) {
+            queries << text + typo;
+            queries << text;
+        }
+    }
+    while (!text.isEmpty()) {
+        text.chop(1);
+        queries << text;
+    }
+    return queries;
+}
+
+QStringList keystrokes(const std::vector<LauncherItem>& items, int rounds, std::mt19937& rng)
+{
+    QStringList queries;
+    std::uniform_int_distribution<size_t> anyItem(0, items.size() - 1);
+    for (int round = 0; round < rounds; ++round) {
+        // A word that exists in the set, an abbreviation and a miss
+        const QString name = items[anyItem(rng)].primary.section(QRegularExpression("[ /_-]"), -2, -2, QString::SectionSkipEmpty);
+        queries << typingSequence(name.isEmpty() ? pick(rng, Words) : name.toLower(), 'q');
+        const QString a = pick(rng, Words);
+        const QString b = pick(rng, Words);
+        queries << typingSequence(a.left(2) + " " + b.left(3), 'z');
+        queries << typingSequence("xyzzy", 'k');
+    }
+    return queries;
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    const size_t rank = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    return values[rank];
+}
+
+QJsonObject distribution(const std::vector<double>& values)
+{
+    QJsonObject object;
+    object["p50"] = percentile(values, 0.50);
+    object["p95"] = percentile(values, 0.95);
+    object["p99"] = percentile(values, 0.99);
+    object["max"] = values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+    return object;
+}
+
+QJsonObject run(const QString& name, std::vector<LauncherItem> items, int rounds, std::mt19937& rng)
+{
+    LauncherModel model;
+    const int itemCount = static_cast<int>(items.size());
+    const QStringList queries = keystrokes(items, rounds, rng);
+
+    QElapsedTimer timer;
+    quint64 allocsBefore = g_allocations.load();
+    timer.start();
+    model.setItems(std::move(items));
+    const double setItemsMs = timer.nsecsElapsed() / 1e6;
+    const quint64 setItemsAllocs = g_allocations.load() - allocsBefore;
+
+    std::vector<double> latencies;
+    std::vector<double> allocations;
+    latencies.reserve(queries.size());
+    allocations.reserve(queries.size());
+    for (const QString& query : queries) {
+        allocsBefore = g_allocations.load();
+        timer.start();
+        model.filter(query);
+        latencies.push_back(timer.nsecsElapsed() / 1e3);
+        allocations.push_back(static_cast<double>(g_allocations.load() - allocsBefore));
+    }
+
+    QJsonObject result;
+    result["corpus"] = name;
+    result["items"] = itemCount;
+    result["keystrokes"] = static_cast<int>(queries.size());
+    result["setItemsMs"] = setItemsMs;
+    result["latencyUs"] = distribution(latencies);
+    if (CountsAllocations) {
+        result["setItemsAllocs"] = static_cast<double>(setItemsAllocs);
+        result["allocsPerKeystroke"] = distribution(allocations);
+    } else {
+        result["setItemsAllocs"] = QJsonValue::Null;
+        result["allocsPerKeystroke"] = QJsonValue::Null;
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bench_filter");
+
+    // Keep the user's history and config out of the numbers, and the
+    // per-keystroke debug logging out of the output.
+    QStandardPaths::setTestModeEnabled(true);
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption corpusOption("corpus", "Corpus to run: desktop, path, dmenu or all.", "name", "all");
+    QCommandLineOption roundsOption("rounds", "Typing sequences per corpus.", "count", "5");
+    parser.addOption(corpusOption);
+    parser.addOption(roundsOption);
+    parser.process(app);
+
+    const QString corpus = parser.value(corpusOption);
+    const int rounds = std::max(1, parser.value(roundsOption).toInt());
+    std::mt19937 rng(42);
+
+    struct Corpus {
+        QString name;
+        int size;
+        std::vector<LauncherItem> (*generate)(int, std::mt19937&);
+    };
+    const Corpus corpora[] = {
+        {"desktop", 5000, desktopCorpus},
+        {"path", 50000, pathCorpus},
+        {"dmenu", 1000000, dmenuCorpus},
+    };
+
+    bool ran = false;
+    for (const auto& entry : corpora) {
+        if (corpus != "all" && corpus != entry.name) continue;
+        const QJsonObject result = run(entry.name, entry.generate(entry.size, rng), rounds, rng);
+        std::printf("%s\n", QJsonDocument(result).toJson(QJsonDocument::Compact).constData());
+        std::fflush(stdout);
+        ran = true;
+    }
+
+    if (!ran) {
+        std::fprintf(stderr, "Unknown corpus: %s\n", qPrintable(corpus));
+        return 1;
+    }
+    return 0;
+}
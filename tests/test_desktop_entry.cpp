@@ -0,0 +1,192 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "App/providers/DesktopEntryParser.h"
+#include "App/providers/DesktopFileLoader.h"
+
+class TestDesktopEntry : public QObject
+{
+    Q_OBJECT
+
+private:
+    // A minimal launchable entry with @p lines added to [Desktop Entry]
+    static QByteArray entryWith(const QByteArray& lines) {
+        return "[Desktop Entry]\nType=Application\nExec=app\n" + lines + "\n";
+    }
+
+    static DesktopEntryParser::Group parseMain(const QByteArray& data, const QByteArray& locale = QByteArray()) {
+        DesktopEntryParser::Entry entry;
+        if (!DesktopEntryParser(locale).parse(data, entry)) {
+            qWarning() << "Not a desktop entry:" << data;
+        }
+        return entry.entry;
+    }
+
+private slots:
+    void testEscapes_data() {
+        QTest::addColumn<QByteArray>("value");
+        QTest::addColumn<QString>("expected");
+
+        QTest::newRow("empty") << QByteArray("") << "";
+        QTest::newRow("plain") << QByteArray("Firefox") << "Firefox";
+        QTest::newRow("space") << QByteArray("a\\sb") << "a b";
+        QTest::newRow("controls") << QByteArray("1\\n2\\t3\\r4") << "1\n2\t3\r4";
+        QTest::newRow("backslash") << QByteArray("back\\\\slash") << "back\\slash";
+        QTest::newRow("semicolon") << QByteArray("semi\\;colon") << "semi;colon";
+        QTest::newRow("double escape") << QByteArray("\\\\s") << "\\s";
+        QTest::newRow("unknown escape") << QByteArray("a\\xb") << "a\\xb";
+        QTest::newRow("trailing backslash") << QByteArray("end\\") << "end\\";
+        QTest::newRow("padded") << QByteArray("  padded  ") << "padded";
+        QTest::newRow("plain separators") << QByteArray("a, b; c") << "a, b; c";
+        QTest::newRow("utf-8") << QByteArray("Caf\xc3\xa9") << QString::fromUtf8("Caf\xc3\xa9");
+    }
+
+    void testEscapes() {
+        QFETCH(QByteArray, value);
+        QFETCH(QString, expected);
+        QCOMPARE(parseMain(entryWith("Name=" + value)).name, expected);
+    }
+
+    void testLists_data() {
+        QTest::addColumn<QByteArray>("value");
+        QTest::addColumn<QStringList>("expected");
+
+        QTest::newRow("empty") << QByteArray("") << QStringList();
+        QTest::newRow("terminated") << QByteArray("a;b;c;") << QStringList{"a", "b", "c"};
+        QTest::newRow("unterminated") << QByteArray("a;b") << QStringList{"a", "b"};
+        QTest::newRow("empty items") << QByteArray(";a;;b;") << QStringList{"a", "b"};
+        QTest::newRow("escaped separator") << QByteArray("one\\;two;three;") << QStringList{"one;two", "three"};
+        QTest::newRow("escaped backslash") << QByteArray("dir\\\\;next;") << QStringList{"dir\\", "next"};
+        QTest::newRow("other escapes") << QByteArray("sp\\sace;") << QStringList{"sp ace"};
+        QTest::newRow("commas") << QByteArray("a,b;c;") << QStringList{"a,b", "c"};
+    }
+
+    void testLists() {
+        QFETCH(QByteArray, value);
+        QFETCH(QStringList, expected);
+        const auto group = parseMain(entryWith("Keywords=" + value + "\nCategories=" + value +
+                                               "\nOnlyShowIn=" + value + "\nActions=" + value));
+        QCOMPARE(group.keywords, expected);
+        QCOMPARE(group.categories, expected);
+        QCOMPARE(group.onlyShowIn, expected);
+        QCOMPARE(group.actions, expected);
+    }
+
+    void testLocaleFallback_data() {
+        QTest::addColumn<QByteArray>("locale");
+        QTest::addColumn<QString>("expected");
+
+        // lang_COUNTRY@MODIFIER > lang_COUNTRY > lang@MODIFIER > lang > unlocalized
+        QTest::newRow("full match") << QByteArray("sr_YU.UTF-8@latin") << "full";
+        QTest::newRow("country") << QByteArray("sr_YU") << "country";
+        QTest::newRow("country, encoding") << QByteArray("sr_YU.UTF-8") << "country";
+        QTest::newRow("modifier") << QByteArray("sr@latin") << "modifier";
+        QTest::newRow("other country, modifier") << QByteArray("sr_RS@latin") << "modifier";
+        QTest::newRow("other country") << QByteArray("sr_RS") << "lang";
+        QTest::newRow("lang") << QByteArray("sr") << "lang";
+        QTest::newRow("other lang") << QByteArray("de_DE") << "default";
+        QTest::newRow("C") << QByteArray("C") << "default";
+        QTest::newRow("POSIX") << QByteArray("POSIX") << "default";
+        QTest::newRow("none") << QByteArray() << "default";
+    }
+
+    void testLocaleFallback() {
+        QFETCH(QByteArray, locale);
+        QFETCH(QString, expected);
+
+        // Localized keys before and after the default: the order must not matter
+        const QByteArray lines = "Name[sr_YU@latin]=full\n"
+                                 "Name[sr]=lang\n"
+                                 "Name=default\n"
+                                 "Name[sr@latin]=modifier\n"
+                                 "Name[sr_YU]=country\n"
+                                 "Name[sr_YU]=duplicate\n"
+                                 "Comment[sr]=comment\n";
+        const auto group = parseMain(entryWith(lines), locale);
+        QCOMPARE(group.name, expected);
+        QCOMPARE(group.comment, locale.startsWith("sr") ? QString("comment") : QString());
+    }
+
+    void testActionGroups() {
+        const QByteArray data = "# Comment\n"
+                                "[Desktop Entry]\n"
+                                "Type=Application\n"
+                                "Name=Editor\n"
+                                "Name[de]=Bearbeiter\n"
+                                "Exec=editor %F\n"
+                                "Actions=new-window;unlisted;\n"
+                                "\n"
+                                "[Desktop Action new-window]\n"
+                                "Name=New Window\n"
+                                "Name[de]=Neues Fenster\n"
+                                "Exec=editor --new-window\n"
+                                "Icon=window-new\n"
+                                "\n"
+                                "[Other Group]\n"
+                                "Name=Ignored\n"
+                                "\n"
+                                "[Desktop Entry]\n"
+                                "Name=Repeated groups are invalid\n"
+                                "\n"
+                                "[Desktop Action unlisted]\n"
+                                "Name=Unlisted\n"
+                                "Exec=editor --unlisted\n";
+
+        DesktopEntryParser::Entry entry;
+        QVERIFY(DesktopEntryParser("de_DE.UTF-8").parse(data, entry));
+        QCOMPARE(entry.entry.name, QString("Bearbeiter"));
+        QCOMPARE(entry.entry.exec, QString("editor %F"));
+        QCOMPARE(entry.entry.actions, (QStringList{"new-window", "unlisted"}));
+
+        QCOMPARE(entry.actions.size(), 2);
+        QCOMPARE(entry.actions[0].first, QString("new-window"));
+        QCOMPARE(entry.actions[0].second.name, QString("Neues Fenster"));
+        QCOMPARE(entry.actions[0].second.exec, QString("editor --new-window"));
+        QCOMPARE(entry.actions[0].second.icon, QString("window-new"));
+        QCOMPARE(entry.actions[1].first, QString("unlisted"));
+        QCOMPARE(entry.actions[1].second.name, QString("Unlisted"));
+    }
+
+    void testNoDesktopEntry() {
+        DesktopEntryParser::Entry entry;
+        QVERIFY(!DesktopEntryParser(QByteArray()).parse("[Desktop Action x]\nName=X\n", entry));
+        QVERIFY(!DesktopEntryParser(QByteArray()).parse("", entry));
+    }
+
+    void testHiddenNoDisplay_data() {
+        QTest::addColumn<QByteArray>("lines");
+        QTest::addColumn<bool>("hidden");
+        QTest::addColumn<bool>("noDisplay");
+
+        QTest::newRow("neither") << QByteArray() << false << false;
+        QTest::newRow("hidden") << QByteArray("Hidden=true") << true << false;
+        QTest::newRow("no display") << QByteArray("NoDisplay=true") << false << true;
+        QTest::newRow("numeric") << QByteArray("NoDisplay=1") << false << true;
+        QTest::newRow("false") << QByteArray("Hidden=false\nNoDisplay=false") << false << false;
+        QTest::newRow("both") << QByteArray("Hidden = true\nNoDisplay=true") << true << true;
+    }
+
+    void testHiddenNoDisplay() {
+        QFETCH(QByteArray, lines);
+        QFETCH(bool, hidden);
+        QFETCH(bool, noDisplay);
+
+        const auto group = parseMain(entryWith("Name=App\n" + lines));
+        QCOMPARE(group.hidden, hidden);
+        QCOMPARE(group.noDisplay, noDisplay);
+
+        // The loader lists neither
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QFile file(dir.filePath("app.desktop"));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(entryWith("Name=App\n" + lines));
+        file.close();
+
+        const auto entry = DesktopFileLoader::parseFile(file.fileName());
+        QCOMPARE(entry.id, QString("app.desktop"));
+        QCOMPARE(entry.items.empty(), hidden || noDisplay);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestDesktopEntry)
+#include "test_desktop_entry.moc"
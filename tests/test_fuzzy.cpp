@@ -29,6 +29,76 @@ private slots:
         QCOMPARE(result.positions[1], 2); // 'z'
         QCOMPARE(result.positions[2], 6); // 'f' in finder
     }
+
+    void testFoldedMatchesPlain() {
+        // The pre-folded path used by the filter loop must score identically
+        const QString target = "GNU Image Manipulation Program";
+        QVector<QChar> folded(target.size());
+        QVector<quint8> flags(target.size());
+        FuzzyMatcher::foldText(target, folded.data(), flags.data());
+
+        QCOMPARE(flags[0], quint8(FuzzyMatcher::WordStart));
+        QCOMPARE(flags[1], quint8(0));
+        QCOMPARE(flags[4], quint8(FuzzyMatcher::WordStart)); // 'I' after space
+
+        FuzzyMatcher::FoldedText text;
+        text.original = target.constData();
+        text.folded = folded.constData();
+        text.flags = flags.constData();
+        text.length = target.size();
+
+        const QStringList queries = { "gimp", "GNU", "imp", "manip", "xyz" };
+        for (const QString& query : queries) {
+            QVector<int> positions;
+            auto expected = FuzzyMatcher::match(query, target);
+            int score = FuzzyMatcher::matchFolded(FuzzyMatcher::foldQuery(query), text, positions);
+            QCOMPARE(score, expected.score);
+            QCOMPARE(positions, expected.positions);
+
+            // Ranking uses the score-only variants; they must agree exactly
+            QCOMPARE(FuzzyMatcher::scoreFolded(FuzzyMatcher::foldQuery(query), text), expected.score);
+            QCOMPARE(FuzzyMatcher::scoreOptimal(FuzzyMatcher::foldQuery(query), text),
+                     FuzzyMatcher::matchOptimal(FuzzyMatcher::foldQuery(query), text, positions));
+        }
+    }
+
+    void testOptimalAlignment() {
+        // Greedy takes the first 'b'; the word-boundary 'b' later scores higher
+        const QString target = "fooxbar foo_bar";
+        QVector<QChar> folded(target.size());
+        QVector<quint8> flags(target.size());
+        FuzzyMatcher::foldText(target, folded.data(), flags.data());
+
+        FuzzyMatcher::FoldedText text;
+        text.original = target.constData();
+        text.folded = folded.constData();
+        text.flags = flags.constData();
+        text.length = target.size();
+
+        const auto query = FuzzyMatcher::foldQuery("fb");
+        QVector<int> greedyPositions;
+        QVector<int> optimalPositions;
+        int greedy = FuzzyMatcher::matchFolded(query, text, greedyPositions);
+        int optimal = FuzzyMatcher::matchOptimal(query, text, optimalPositions);
+
+        QCOMPARE(greedy, 386);
+        QCOMPARE(optimal, 478);
+        QCOMPARE(optimalPositions, QVector<int>({0, 12}));
+
+        // Never worse than greedy, and no match stays no match
+        QVERIFY(FuzzyMatcher::matchOptimal(FuzzyMatcher::foldQuery("fo"), text, optimalPositions) >=
+                FuzzyMatcher::matchFolded(FuzzyMatcher::foldQuery("fo"), text, greedyPositions));
+        QCOMPARE(FuzzyMatcher::matchOptimal(FuzzyMatcher::foldQuery("zz"), text, optimalPositions), 0);
+    }
+
+    void testPrefixTier() {
+        auto result = FuzzyMatcher::match("fire", "Firefox");
+        QVERIFY(result.isPrefix);
+        QVERIFY(!result.isExact);
+        QCOMPARE(result.score, 5040);
+
+        QVERIFY(FuzzyMatcher::match("firefox", "Firefox").isExact);
+    }
 };
 
 QTEST_MAIN(TestFuzzy)
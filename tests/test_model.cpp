@@ -0,0 +1,162 @@
+#include <QtTest>
+#include <QAbstractItemModelTester>
+#include <QTemporaryDir>
+#include <algorithm>
+#include "App/models/LauncherModel.h"
+#include "App/models/RankingContext.h"
+
+class TestLauncherModel : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_home;
+
+    // More than a few pages, with names that many queries match partially
+    static std::vector<LauncherItem> makeItems(int count, const QString& suffix = QString()) {
+        static const char* const Words[] = {
+            "firefox", "files", "fish", "office", "writer", "terminal", "editor",
+            "image", "viewer", "mail", "music", "player", "settings", "monitor",
+            "calculator", "calendar", "document", "scanner", "fonts", "archive"
+        };
+        constexpr int WordCount = sizeof(Words) / sizeof(Words[0]);
+
+        std::vector<LauncherItem> items;
+        for (int i = 0; i < count; ++i) {
+            LauncherItem item;
+            item.id = QString("app:%1").arg(i);
+            item.primary = QString("%1 %2%3").arg(Words[i % WordCount], Words[(i * 7 + 3) % WordCount], suffix);
+            item.secondary = QString("Item %1").arg(i);
+            item.exec = item.primary;
+            items.push_back(std::move(item));
+        }
+        return items;
+    }
+
+    static QStringList rowIds(const LauncherModel& model) {
+        QStringList ids;
+        for (int row = 0; row < model.rowCount(); ++row) {
+            ids << model.data(model.index(row), LauncherModel::IdRole).toString();
+        }
+        return ids;
+    }
+
+    // Rows a model that never saw an earlier query shows for @p query
+    static QStringList coldRowIds(std::vector<LauncherItem> items, const QString& query, int rows,
+                                  std::shared_ptr<const RankingContext> ranking = nullptr) {
+        LauncherModel model;
+        if (ranking) model.setRankingContext(std::move(ranking));
+        model.setItems(std::move(items));
+        model.filter(query);
+        while (model.rowCount() < rows && model.canFetchMore(QModelIndex())) {
+            model.fetchMore(QModelIndex());
+        }
+        return rowIds(model);
+    }
+
+private slots:
+    void initTestCase() {
+        // No activation history and the default config: no boosts, no pins
+        QVERIFY(m_home.isValid());
+        qputenv("XDG_CACHE_HOME", QFile::encodeName(m_home.filePath("cache")));
+        qputenv("XDG_CONFIG_HOME", QFile::encodeName(m_home.filePath("config")));
+    }
+
+    void testRowDiffMatchesFreshModel() {
+        LauncherModel model;
+        QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+        model.setItems(makeItems(300));
+
+        // Growing, shrinking, unrelated and empty queries; some steps load
+        // more pages first, so the diff also has to drop rows
+        const QStringList queries = {
+            "f", "fi", "fil", "files", "fi", "", "o", "of", "off", "office w",
+            "zzz", "e", "er", "ter", "mon", "", "a", "ar", "arc", "c", "ca", "cal"
+        };
+        int step = 0;
+        for (const QString& query : queries) {
+            if (++step % 3 == 0) {
+                model.fetchMore(QModelIndex());
+            }
+            model.filter(query);
+            QCOMPARE(rowIds(model), coldRowIds(makeItems(300), query, model.rowCount()));
+        }
+    }
+
+    void testReplaceItemsMatchesFreshModel() {
+        LauncherModel model;
+        QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+        model.setItems(makeItems(200));
+        model.filter("fi");
+
+        // Fewer items, renamed: rows go, move and change in place
+        std::vector<LauncherItem> refreshed = makeItems(150, " 2");
+        std::reverse(refreshed.begin(), refreshed.end());
+        model.replaceItems(LauncherModel::prepareItems(refreshed, model.rankingContext()));
+        QCOMPARE(rowIds(model), coldRowIds(refreshed, "fi", model.rowCount()));
+    }
+
+    void testFilterCache_data() {
+        QTest::addColumn<QStringList>("queries");
+
+        QTest::newRow("backspace, other char") << QStringList{"f", "fi", "fir", "fi", "fil"};
+        QTest::newRow("back to one char") << QStringList{"f", "fi", "fil", "fi", "f", "fo"};
+        QTest::newRow("back to empty") << QStringList{"f", "fi", "f", "", "m", "mu"};
+        QTest::newRow("pasted") << QStringList{"f", "music", "m", "mo"};
+        QTest::newRow("case") << QStringList{"F", "Fi", "fil", "FI", "fis"};
+        QTest::newRow("no match") << QStringList{"x", "xz", "x", "xy"};
+    }
+
+    void testFilterCache() {
+        QFETCH(QStringList, queries);
+
+        // Each keystroke narrows or restores a cached result set; every
+        // step must show what a cold filter() of the same text shows
+        LauncherModel model;
+        model.setItems(makeItems(300));
+        for (const QString& query : queries) {
+            model.filter(query);
+            QCOMPARE(rowIds(model), coldRowIds(makeItems(300), query, model.rowCount()));
+        }
+    }
+
+    void testRankingContextClearsFilterCache() {
+        LauncherModel model;
+        model.setItems(makeItems(300));
+        model.filter("f");
+        model.filter("fi");
+
+        // Pins and the scorer change mid-typing: cached scores are stale
+        auto ranking = std::make_shared<RankingContext>();
+        ranking->pinBoosts.insert("app:42", 1000);
+        ranking->pinBoosts.insert("app:7", 900);
+        ranking->algorithm = FuzzyMatcher::Optimal;
+        model.setRankingContext(ranking);
+
+        for (const QString& query : {QString("fil"), QString("fi"), QString("f"), QString("fe")}) {
+            model.filter(query);
+            QCOMPARE(rowIds(model), coldRowIds(makeItems(300), query, model.rowCount(), ranking));
+        }
+    }
+
+    void testReplaceItemsClearsFilterCache() {
+        LauncherModel model;
+        model.setItems(makeItems(300));
+        model.filter("f");
+        model.filter("fi");
+
+        // A different set under the cached prefixes: none of the cached
+        // matches may come back
+        std::vector<LauncherItem> refreshed = makeItems(120, " 2");
+        std::reverse(refreshed.begin(), refreshed.end());
+        model.replaceItems(LauncherModel::prepareItems(refreshed, model.rankingContext()));
+
+        for (const QString& query : {QString("fil"), QString("fi"), QString("f"), QString("fo")}) {
+            model.filter(query);
+            QCOMPARE(rowIds(model), coldRowIds(refreshed, query, model.rowCount()));
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestLauncherModel)
+#include "test_model.moc"
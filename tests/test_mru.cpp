@@ -0,0 +1,150 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <memory>
+#include "App/utils/IdHash.h"
+#include "App/utils/MRUTracker.h"
+
+// Mirrors the journal record in MRUTracker.cpp
+struct JournalRecord {
+    quint64 hash;
+    qint64 when;
+};
+
+class TestMRUTracker : public QObject
+{
+    Q_OBJECT
+
+private:
+    std::unique_ptr<QTemporaryDir> m_cache;
+
+    static qint64 now() { return QDateTime::currentMSecsSinceEpoch(); }
+    static qint64 daysAgo(double days) { return now() - static_cast<qint64>(days * 86400000.0); }
+
+    static QString journalPath() { return MRUTracker::historyDir() + "/history.log"; }
+    static QString snapshotPath() { return MRUTracker::historyDir() + "/history.bin"; }
+
+    static void writeJournal(const QVector<JournalRecord>& records, const QByteArray& tail = QByteArray()) {
+        QDir().mkpath(MRUTracker::historyDir());
+        QFile file(journalPath());
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(reinterpret_cast<const char*>(records.constData()),
+                   records.size() * static_cast<qint64>(sizeof(JournalRecord)));
+        file.write(tail);
+    }
+
+    static QHash<quint64, int> boostsOf(const MRUTracker& tracker) {
+        return tracker.boosts(now(), nullptr);
+    }
+
+private slots:
+    void init() {
+        // Each test starts from an empty cache directory
+        m_cache = std::make_unique<QTemporaryDir>();
+        QVERIFY(m_cache->isValid());
+        qputenv("XDG_CACHE_HOME", QFile::encodeName(m_cache->path()));
+    }
+
+    void testActivationsSurviveReload() {
+        auto* tracker = new MRUTracker;
+        tracker->recordActivation("app:a");
+        tracker->recordActivation("app:a");
+        tracker->recordActivation("app:b");
+        delete tracker; // Waits for the writer
+
+        tracker = new MRUTracker;
+        const auto boosts = boostsOf(*tracker);
+        delete tracker;
+        QCOMPARE(boosts.size(), 2);
+        QCOMPARE(boosts.value(idHash(u"app:a")), 400);
+        QCOMPARE(boosts.value(idHash(u"app:b")), 200);
+    }
+
+    void testCompactionKeepsEveryActivation() {
+        const int activations = MRUTracker::CompactThreshold + 10;
+        auto* tracker = new MRUTracker;
+        for (int i = 0; i < activations; ++i) {
+            tracker->recordActivation(QString("app:%1").arg(i % 5));
+        }
+        delete tracker;
+
+        // Folded into the snapshot once, the rest still journaled
+        QVERIFY(QFile::exists(snapshotPath()));
+        QCOMPARE(QFileInfo(journalPath()).size(), qint64(10 * sizeof(JournalRecord)));
+
+        MRUTracker::History history;
+        QVERIFY(MRUTracker::readSnapshot(snapshotPath(), history));
+        MRUTracker::replayJournal(journalPath(), history);
+        QCOMPARE(history.size(), 5);
+        quint32 total = 0;
+        for (const auto& entry : history) total += entry.count;
+        QCOMPARE(total, quint32(activations));
+
+        tracker = new MRUTracker;
+        const auto boosts = boostsOf(*tracker);
+        delete tracker;
+        for (int i = 0; i < 5; ++i) {
+            QCOMPARE(boosts.value(idHash(QString("app:%1").arg(i))), 1000); // MaxBoost
+        }
+    }
+
+    void testTruncatedJournalTailIsIgnored() {
+        const qint64 t = now();
+        writeJournal({{idHash(u"app:a"), t - 1000},
+                      {idHash(u"app:a"), t - 500},
+                      // Garbage from the future would never decay
+                      {idHash(u"app:future"), t + 10 * 86400000LL}},
+                     QByteArray(7, '\xff')); // A torn record
+
+        auto* tracker = new MRUTracker;
+        auto boosts = boostsOf(*tracker);
+        QCOMPARE(boosts.size(), 1);
+        QCOMPARE(boosts.value(idHash(u"app:a")), 400);
+
+        // The next append realigns the journal before writing
+        tracker->recordActivation("app:c");
+        delete tracker;
+        QCOMPARE(QFileInfo(journalPath()).size(), qint64(4 * sizeof(JournalRecord)));
+
+        tracker = new MRUTracker;
+        boosts = boostsOf(*tracker);
+        delete tracker;
+        QCOMPARE(boosts.size(), 2);
+        QCOMPARE(boosts.value(idHash(u"app:a")), 400);
+        QCOMPARE(boosts.value(idHash(u"app:c")), 200);
+    }
+
+    void testDecayedEntriesAreEvicted() {
+        writeJournal({{idHash(u"app:stale"), daysAgo(60)}, // 2^-60/7 < EvictBelow
+                      {idHash(u"app:recent"), daysAgo(7)}});
+
+        auto* tracker = new MRUTracker;
+        const auto boosts = boostsOf(*tracker);
+        QCOMPARE(boosts.value(idHash(u"app:recent")), 100); // One half-life
+        tracker->compact();
+        delete tracker;
+
+        MRUTracker::History history;
+        QVERIFY(MRUTracker::readSnapshot(snapshotPath(), history));
+        QVERIFY(history.contains(idHash(u"app:recent")));
+        QVERIFY(!history.contains(idHash(u"app:stale")));
+        QCOMPARE(QFileInfo(journalPath()).size(), qint64(0));
+    }
+
+    void testLegacyHistoryIsImported() {
+        QDir().mkpath(MRUTracker::historyDir());
+        QFile legacy(MRUTracker::historyDir() + "/history.json");
+        QVERIFY(legacy.open(QIODevice::WriteOnly));
+        legacy.write(QString(R"({"history": [{"id": "app:old", "count": 3, "last": %1}]})")
+                         .arg(now()).toUtf8());
+        legacy.close();
+
+        auto* tracker = new MRUTracker;
+        const auto boosts = boostsOf(*tracker);
+        delete tracker;
+        QVERIFY(QFile::exists(snapshotPath()));
+        QCOMPARE(boosts.value(idHash(u"app:old")), 600);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestMRUTracker)
+#include "test_mru.moc"
@@ -0,0 +1,156 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <fcntl.h>
+#include <memory>
+#include <sys/stat.h>
+#include "App/providers/SSHProvider.h"
+
+class TestSSHProvider : public QObject
+{
+    Q_OBJECT
+
+private:
+    std::unique_ptr<QTemporaryDir> m_home;
+
+    static QString sshPath(const QString& name) { return QDir::homePath() + "/.ssh/" + name; }
+
+    // Writes ~/.ssh/@p name; a later write gets a later mtime even on
+    // filesystems with coarse timestamps
+    static void write(const QString& name, const QByteArray& content) {
+        static int generation = 0;
+        const QString path = sshPath(name);
+        QDir().mkpath(QFileInfo(path).path());
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(content);
+        QVERIFY(file.flush()); // Or closing would set the mtime again
+        QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(++generation),
+                                 QFileDevice::FileModificationTime));
+    }
+
+    // Moves the mtime of directory ~/.ssh/@p name ahead, as adding a file does
+    static void touchDir(const QString& name) {
+        struct timespec times[2] = {{0, UTIME_OMIT}, {0, 0}};
+        times[1].tv_sec = QDateTime::currentSecsSinceEpoch() + 1000;
+        QCOMPARE(::utimensat(AT_FDCWD, QFile::encodeName(sshPath(name)).constData(), times, 0), 0);
+    }
+
+private slots:
+    void init() {
+        // Each test gets its own home (for ~/.ssh) and cache directory
+        m_home = std::make_unique<QTemporaryDir>();
+        QVERIFY(m_home->isValid());
+        qputenv("HOME", QFile::encodeName(m_home->path()));
+        qputenv("XDG_CACHE_HOME", QFile::encodeName(m_home->filePath(".cache")));
+    }
+
+    void testRelativeInclude() {
+        write("config", "Include conf.d/work\n"
+                        "Include ~/.ssh/extra\n"
+                        "Host main\n");
+        write("conf.d/work", "Host work-a work-b\n");
+        write("extra", "Host extra\n");
+
+        // Included hosts come where the Include line is
+        QCOMPARE(SSHProvider::parse(false).configHosts, (QStringList{"work-a", "work-b", "extra", "main"}));
+    }
+
+    void testGlobInclude() {
+        write("config", "Include conf.d/*.conf\n"
+                        "Include missing/*\n");
+        write("conf.d/b.conf", "Host b\n");
+        write("conf.d/a.conf", "Host a\n");
+        write("conf.d/c.txt", "Host c\n");
+
+        // Matches are read in sorted order
+        QCOMPARE(SSHProvider::parse(false).configHosts, (QStringList{"a", "b"}));
+    }
+
+    void testIncludeCycle() {
+        write("config", "Include loop1\n"
+                        "Host top\n");
+        write("loop1", "Host one\n"
+                       "Include loop2\n");
+        write("loop2", "Include loop1\n"
+                       "Include config\n"
+                       "Host two\n");
+
+        QCOMPARE(SSHProvider::parse(false).configHosts, (QStringList{"one", "two", "top"}));
+    }
+
+    void testIncludeDepth() {
+        write("config", "Host h0\nInclude f1\n");
+        for (int i = 1; i < 20; ++i) {
+            write(QString("f%1").arg(i), QString("Host h%1\nInclude f%2\n").arg(i).arg(i + 1).toUtf8());
+        }
+
+        // Nesting stops where ssh stops it
+        const QStringList hosts = SSHProvider::parse(false).configHosts;
+        QCOMPARE(hosts.size(), 17);
+        QCOMPARE(hosts.first(), QString("h0"));
+        QCOMPARE(hosts.last(), QString("h16"));
+    }
+
+    void testHostPatterns() {
+        write("config", "Host alpha *.example.com !bastion beta web-?\n"
+                        "  HostName alpha.example.com\n"
+                        "host=gamma\n"
+                        "HOST \"delta\" alpha\n"
+                        "# Host commented\n"
+                        "Match host epsilon\n");
+        write("known_hosts", "alpha,10.0.0.1 ssh-ed25519 AAAA\n"
+                             "|1|c2FsdA==|aGFzaA== ssh-ed25519 AAAA\n"
+                             "[gateway]:2222 ssh-ed25519 AAAA\n"
+                             "@cert-authority *.example.com ssh-ed25519 AAAA\n"
+                             "# comment\n"
+                             "\n"
+                             "zeta ssh-rsa AAAA\n"
+                             "zeta,10.0.0.1 ssh-ecdsa AAAA");
+
+        const SSHProvider::Hosts hosts = SSHProvider::parse(true);
+        QCOMPARE(hosts.configHosts, (QStringList{"alpha", "beta", "gamma", "delta"}));
+        // Known hosts already in the config are listed once
+        QCOMPARE(hosts.knownHosts, (QStringList{"10.0.0.1", "zeta"}));
+
+        const auto items = SSHProvider::toItems(hosts);
+        QCOMPARE(items.size(), size_t(6));
+        QCOMPARE(items.front().id, QString("ssh:alpha"));
+        QCOMPARE(items.front().exec, QString("ssh alpha"));
+        QVERIFY(items.front().terminal);
+
+        QVERIFY(SSHProvider::parse(false).knownHosts.isEmpty());
+    }
+
+    void testCacheInvalidation() {
+        write("config", "Include conf.d/*\n"
+                        "Host main\n");
+        write("conf.d/work", "Host work\n");
+
+        SSHProvider::Hosts hosts = SSHProvider::load(false);
+        QCOMPARE(hosts.configHosts, (QStringList{"work", "main"}));
+        const QString cache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+                              "/awelauncher/ssh.cache";
+        QVERIFY(QFileInfo(cache).size() > 0);
+        QVERIFY(SSHProvider::isFresh(hosts));
+
+        // An included file changes
+        write("conf.d/work", "Host work work-2\n");
+        QVERIFY(!SSHProvider::isFresh(hosts));
+        hosts = SSHProvider::load(false);
+        QCOMPARE(hosts.configHosts, (QStringList{"work", "work-2", "main"}));
+
+        // A new glob match appears: the directory's mtime changes
+        write("conf.d/other", "Host other\n");
+        touchDir("conf.d");
+        QVERIFY(!SSHProvider::isFresh(hosts));
+        hosts = SSHProvider::load(false);
+        QCOMPARE(hosts.configHosts, (QStringList{"other", "work", "work-2", "main"}));
+
+        // Unchanged sources keep the result
+        QVERIFY(SSHProvider::isFresh(hosts));
+        QCOMPARE(SSHProvider::load(false).configHosts, hosts.configHosts);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestSSHProvider)
+#include "test_ssh.moc"